@@ -20,12 +20,15 @@
 #ifndef ACTOR_HXX_
 #define ACTOR_HXX_
 
+#include "action.hxx"
 #include "character.hxx"
 
 class Actor {
 public:
     Actor(Character* character);
     virtual ~Actor() { }
+    /** Start or stop an action. Value is the speed of moves, else 0 or 1. */
+    bool act(ActionType action, double value);
 protected:
     Character* character_;
 private:
@@ -24,6 +24,9 @@
 #include "game_graphics_gl.hxx"
 #include "game_physics.hxx"
 #include "action.hxx"
+#include "character_controller.hxx"
+#include "debris_manager.hxx"
+#include "state_frame.hxx"
 
 class Character {
 public:
@@ -35,17 +38,54 @@ public:
         void changeMass(phys_t delta);
     protected:
         Character* parent_;
-        phys_t walkCycle_;
-        bool interact(AstroBody* b, double dt, vector2p& p, vector2p& im);
+        /** Phase of the walk cycle, as a unit rotor. */
+        vector2p walkCycle_;
+        /**
+         * Horizontal speed over the planet, and the length and direction
+         * of the legs, as aimed by probe for interact.
+         */
+        phys_t hVel_, leg_;
+        vector2p legDir_;
+        bool probe(AstroBody* b, RayQuery& q);
+        bool interact(AstroBody* b, const RayHit& hit, double dt,
+                vector2p& p, vector2p& im);
     private:
         CharacterBody(const CharacterBody&);
         CharacterBody& operator=(const CharacterBody&);
+        friend class Character;
     };
     Character(state2p state, phys_t orientation, Material* materialBody,
             Material* materialHead, Material* materialLimbs, Material*
-            materialLimbsOff);
+            materialLimbsOff, CharacterController* controller);
+    ~Character();
+    /**
+     * Put the character's bodies and links into a universe, in a collision
+     * group of their own, with its collision handler watching them.
+     */
     void addToUniverse(GameUniverse* u);
+    /** Take the character's bodies and links out of the universe again. */
+    void removeFromUniverse(GameUniverse* u);
+    /** Hand the parts to a debris manager when the character dies. */
+    void setDebrisManager(DebrisManager* d);
+    /**
+     * Save what the universe and controller do not: whether the character
+     * is dead, its walk, size, fading and link targets.
+     */
+    void save(Snapshot& s);
+    void restore(Snapshot& s);
+    /** Write what can be seen of the character into its frame values. */
+    void getFrame(int* values);
+    /**
+     * Show the character as in its frame values, without simulating it,
+     * as a client of a server does.
+     */
+    void setFrame(const int* values);
     bool isDead();
+    /**
+     * Get the bodies: the body, head, back foot, front foot, back hand and
+     * front hand.
+     */
+    void getBodies(SmallBody* bodies[6]);
     char getOrientation();
     phys_t getMass();
     double getVel();
@@ -63,33 +103,34 @@ public:
     void moveRight(double vel);
     void rightKick(bool state);
     void rightPunch(bool state);
-    /** Update power meters. */
-    void update(double deltaTime);
 private:
     Character(const Character&);
     Character& operator=(const Character&);
-    class Action {
-    public:
-        Action();
-        bool intention;
-        phys_t power;
-    };
     bool dead_;
-    double vel_;
-    Action actions_[NUM_ACTIONTYPE];
+    /** Controller holding this character's intentions and power meters. */
+    CharacterController* controller_;
+    /** Handle of this character in the controller. */
+    Handle handle_;
     Circle<phys_t> shapeBody_, shapeHead_, shapeFoot_, shapeHand_;
     CharacterBody body_;
     FixtureSpring neck_, legBack_, legFront_, armBack_, armFront_;
-    static int _collisionGroup_;
     SmallBody head_, footBack_, footFront_, handBack_, handFront_;
     Material* materialLimbsOff_;
+    /** Handles of the bodies and links, while in a universe. */
+    Handle bodyHandles_[6], linkHandles_[5];
+    DebrisManager* debris_;
+    /** Opacity of each body, in the order of bodyHandles_. */
+    float fade_[6];
+    bool getIntention(ActionType a);
+    phys_t getPower(ActionType a);
     state2p getStateAt(vector2p p);
     friend class CharacterGraphic;
 };
 
 class CharacterGraphic: public StackGraphic {
 public:
-    CharacterGraphic(Character* c);
+    /** Draw a character in colour number colour, loading its textures. */
+    CharacterGraphic(Character* c, TextureLoader* textures, int colour);
     ColorModifier* getColourModifier();
     void update();
 private:
@@ -100,6 +141,8 @@ private:
     GraphicFixture bodyFixture_, headFixture_,
             footBackFixture_, footFrontFixture_,
             handBackFixture_, handFrontFixture_;
+    FadeModifier bodyFade_, headFade_, footBackFade_, footFrontFade_,
+            handBackFade_, handFrontFade_;
     ColorModifier bodyColor_;
     float colour_[3];
     SizeModifier scaler_;
@@ -107,7 +150,13 @@ private:
            handBack_, handFront_;
     /** Pointer to left- or right-facing sprite, depending on orientation. */
     Sprite* body_, * head_;
+    /** Bit i is set if part i, in the order of Character::fade_, is drawn. */
+    int shown_;
     bool updateOrientation();
+    /** Whether the parts drawn have changed. */
+    bool updateShown();
+    /** Stack the parts that are drawn, back to front. */
+    void restack();
 };
 
 #endif /* CHARACTER_HXX_ */
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHARACTER_CONTROLLER_HXX_
+#define CHARACTER_CONTROLLER_HXX_
+
+#include <vector>
+#include "action.hxx"
+#include "handle_table.hxx"
+#include "physics.hxx"
+#include "snapshot.hxx"
+
+/**
+ * Action intentions and power meters of all characters. Each meter is kept
+ * in its own contiguous array, indexed by character, so that update runs as
+ * one branch-free pass per meter over every character.
+ */
+class CharacterController {
+public:
+    CharacterController();
+    /** Add a character with no intentions and empty meters. */
+    Handle add();
+    /** Remove a character. The last character takes its place. */
+    void remove(Handle c);
+    int getNumCharacters();
+    /**
+     * The accessors read a removed character's intentions and meters as
+     * zero, and ignore setting them.
+     */
+    bool getIntention(Handle c, ActionType a);
+    void setIntention(Handle c, ActionType a, bool state);
+    phys_t getPower(Handle c, ActionType a);
+    void setPower(Handle c, ActionType a, phys_t power);
+    phys_t getVel(Handle c);
+    void setVel(Handle c, phys_t vel);
+    /** Set the highest crouch power, which depends on the body's mass. */
+    void setCrouchCap(Handle c, phys_t cap);
+    /** Update the power meters of every character. */
+    void update(phys_t dt);
+    void save(Snapshot& s);
+    void restore(Snapshot& s);
+private:
+    CharacterController(const CharacterController&);
+    CharacterController& operator=(const CharacterController&);
+    /** Intentions as 0 or 1, so that the meters can blend by them. */
+    std::vector<phys_t> intention_[NUM_ACTIONTYPE];
+    std::vector<phys_t> power_[NUM_ACTIONTYPE];
+    std::vector<phys_t> vel_;
+    std::vector<phys_t> crouchCap_;
+    HandleTable characters_;
+};
+
+#endif /* CHARACTER_CONTROLLER_HXX_ */
@@ -21,19 +21,23 @@
 #define COLLISION_HANDLER_HXX_
 
 #include <map>
-#include "character.hxx"
 #include "physics.hxx"
 
+class Character;
+
+/**
+ * Damages the characters whose bodies collide. Each universe has its own,
+ * so that games do not share any state.
+ */
 class CollisionHandler {
 public:
     CollisionHandler();
-    /** Create or return a singleton. */
-    static CollisionHandler* getInstance();
     void collide(Body* body0, Body* body1, phys_t impulse);
     void monitor(Body* body, Character* character);
+    void unmonitor(Body* body);
 private:
-    /** The singleton. */
-    static CollisionHandler* _instance_;
+    CollisionHandler(const CollisionHandler&);
+    CollisionHandler& operator=(const CollisionHandler&);
     std::map<Body*, Character*> monitored_;
 };
 
@@ -20,11 +20,16 @@
 #ifndef CONFIG_PARSER_HXX_
 #define CONFIG_PARSER_HXX_
 
+#include "input_router.hxx"
 #include "player.hxx"
 
 namespace ConfigParser {
-/** Opens the config and reads the keys. */
-void readBindings(Player* player, const char* file);
+/**
+ * Opens the config and binds its keys and buttons to the player. A
+ * [gamepad n] section is for joystick n, counting from 1, and [gamepad]
+ * is for the first.
+ */
+void readBindings(InputRouter* router, Player* player, const char* file);
 }
 
 #endif /* CONFIG_PARSER_HXX_ */
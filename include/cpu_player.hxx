@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CPU_PLAYER_HXX_
+#define CPU_PLAYER_HXX_
+
+#include "actor.hxx"
+#include "character.hxx"
+#include "step_input.hxx"
+
+class Planner;
+
+/** Actor played by the computer, acting on the plans of a planner. */
+class CpuPlayer: public Actor {
+public:
+    /** Play character i of the game the planner plans for. */
+    CpuPlayer(Character* character, Planner* planner, int i);
+    /** Act on the latest plan. Returns the actions now held. */
+    const StepInput& update();
+private:
+    Planner* planner_;
+    int i_;
+    StepInput input_;
+};
+
+#endif /* CPU_PLAYER_HXX_ */
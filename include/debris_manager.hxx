@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEBRIS_MANAGER_HXX_
+#define DEBRIS_MANAGER_HXX_
+
+#include <vector>
+#include "game_physics.hxx"
+#include "handle_table.hxx"
+
+/**
+ * Limits the lifetime and number of bodies nothing holds together any
+ * more, such as the limbs of the dead. Debris fades out at the end of its
+ * lifetime and is then taken out of the universe. If there is more debris
+ * than the budget, the debris farthest outside the focus around the
+ * living characters, or else the oldest, starts fading out early.
+ */
+class DebrisManager {
+public:
+    DebrisManager(GameUniverse* universe, phys_t lifetime, int budget,
+            phys_t fadeTime);
+    /**
+     * Start the lifetime of a body in the universe. Its opacity is written
+     * to fade as it fades out, ending at 0 when it is removed.
+     */
+    void add(SmallBody* body, Handle handle, float* fade);
+    /** Forget a body without removing it, as when its owner goes away. */
+    void release(SmallBody* body);
+    /**
+     * Take a link that held debris together out of the universe. This must
+     * happen before the bodies it joined are removed.
+     */
+    void removeLink(Handle handle);
+    /** Set the area the living characters are in. */
+    void setFocus(vector2p centre, phys_t radius);
+    int getNumDebris();
+    /** Age the debris, and remove what has faded out. */
+    void update(phys_t dt);
+    /** Save the debris, referring to the bodies by index. */
+    void save(Snapshot& s);
+    void restore(Snapshot& s);
+private:
+    DebrisManager(const DebrisManager&);
+    DebrisManager& operator=(const DebrisManager&);
+    struct Debris {
+        SmallBody* body;
+        Handle handle;
+        float* fade;
+        phys_t age, life;
+    };
+    /** Make the most expendable debris that is not fading start to. */
+    bool expire();
+    void remove(int i);
+    GameUniverse* universe_;
+    /**
+     * Every body added, and where its opacity goes, for snapshots to refer
+     * to them by index.
+     */
+    std::vector<SmallBody*> knownBodies_;
+    std::vector<float*> knownFades_;
+    phys_t lifetime_, fadeTime_;
+    int budget_;
+    /** Number of debris that is not yet fading out. */
+    int numSolid_;
+    vector2p focus_;
+    phys_t focusRadius_;
+    std::vector<Debris> debris_;
+};
+
+#endif /* DEBRIS_MANAGER_HXX_ */
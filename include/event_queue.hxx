@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENT_QUEUE_HXX_
+#define EVENT_QUEUE_HXX_
+
+#include <deque>
+#include <SDL/SDL.h>
+
+/**
+ * SDL events stamped with the time they arrive, for applying each at the
+ * step that simulates that moment. A frame simulates the time since the
+ * last frame, so its events are spread over its steps in the order and at
+ * the spacing they came in: one frame late, but at a steady latency, and
+ * never several on the same step because they came in the same frame.
+ *
+ * SDL only gathers events on the thread that set the video mode, so the
+ * queue is filled by polling on that thread, about every millisecond
+ * while the frame waits, rather than by a thread of its own.
+ */
+class EventQueue {
+public:
+    EventQueue();
+    /** Take the events SDL has gathered and stamp them with the time. */
+    void poll();
+    /** Poll about every millisecond for ms milliseconds. */
+    void wait(Uint32 ms);
+    /**
+     * Sleep until there is an event, and take it and any others. Returns
+     * at once if there are events since the last frame already.
+     */
+    void block();
+    /**
+     * Spread the events since the last frame over the next steps steps,
+     * and return how many there are.
+     */
+    int startFrame(int steps);
+    /**
+     * Get the next event due at or before step of the frame, and return
+     * whether there was one. Events not yet spread over a frame are never
+     * due.
+     */
+    bool next(int step, SDL_Event& event);
+private:
+    struct StampedEvent {
+        SDL_Event event;
+        Uint32 time;
+        /** Step of the frame that applies it. */
+        int step;
+    };
+    std::deque<StampedEvent> events_;
+    /** Number of events at the front spread over the frame. */
+    size_t numDue_;
+    /** Time the frame started. */
+    Uint32 frameTime_;
+};
+
+#endif /* EVENT_QUEUE_HXX_ */
@@ -21,14 +21,33 @@
 #ifndef GAME_HXX_
 #define GAME_HXX_
 
+#include "cpu_player.hxx"
 #include "game_graphics_gl.hxx"
 #include "game_physics.hxx"
+#include "input_router.hxx"
 #include "player.hxx"
 #include "screen_element.hxx"
+#include "state_frame.hxx"
+#include "step_input.hxx"
+
+class Planner;
 
 class Game: public EventHandler {
 public:
-    /** Initialise the game. */
+    /** NUM_MATERIAL is a length. */
+    enum MaterialType {
+        BODY,
+        HEAD,
+        LIMBS,
+        LIMBS_OFF,
+        PLANET,
+        NUM_MATERIAL
+    };
+    /**
+     * Initialise the game, with the characters played by the computer
+     * after the players'. Without a screen, the game is headless: it is
+     * simulated, but has no graphics and needs no display.
+     */
     Game(Screen* screen, int numPlayers, int numCPUs);
     virtual ~Game();
     /** Handle input. */
@@ -37,8 +56,59 @@ public:
     void conceive();
     /** Main game loop. */
     void update(phys_t dt);
+    /** Advance the simulation only, leaving the graphics behind. */
+    void step(phys_t dt);
+    /** Bring the graphics up to date with the simulation. */
+    void updateGraphics();
     void updateCamera(GLfloat dt);
     void draw();
+    /**
+     * Add a player on the far side of the planet from the others. Returns
+     * the player's number, or -1 if the game is full. Games with CPU
+     * players keep the players they started with.
+     */
+    int addPlayer();
+    /** Remove player i. The players after it move down one number. */
+    void removePlayer(int i);
+    /**
+     * Add or remove players from the end until there are n, or as near as
+     * there is room for. Games with CPU players keep theirs.
+     */
+    void setNumPlayers(int n);
+    int getNumPlayers();
+    Player* getPlayer(int i);
+    Character* getCharacter(int i);
+    int getNumPlanets();
+    AstroBody* getPlanet(int i);
+    GameUniverse* getUniverse();
+    /** Get the router of the players' input, for binding controls. */
+    InputRouter* getInputRouter();
+    /**
+     * Get a material, for tuning. Changes apply to everything made of it,
+     * including what already exists.
+     */
+    Material* getMaterial(MaterialType m);
+    /**
+     * Give player i the controls of the first player, and nobody else any,
+     * as when the other players are on other machines.
+     */
+    void setLocalPlayer(int i);
+    /** Save the universe, characters and camera. Cheap enough every step. */
+    void save(Snapshot& s);
+    /**
+     * Restore a snapshot taken by this game since the players last
+     * changed, leaving the camera be unless asked. Returns false, and
+     * restores nothing, if players have been added or removed since, or
+     * if the snapshot is from another version or cut short.
+     */
+    bool restore(Snapshot& s, bool camera = true);
+    /** Get what can be seen of the game. */
+    void getFrame(StateFrame& f);
+    /**
+     * Show the game as in a frame, adding or removing players to match.
+     * The game is not simulated in between, only drawn.
+     */
+    void setFrame(const StateFrame& f);
 private:
     Game(const Game&);
     Game& operator=(const Game&);
@@ -56,6 +126,37 @@ private:
     static const phys_t _S;
     /** Planet radius. */
     static const phys_t _PR;
+    /** Height of the hills on the planet. */
+    static const phys_t _PH;
+    /** Seconds debris lasts, including fading out. */
+    static const phys_t _DEBRIS_LIFE;
+    /** Seconds debris takes to fade out. */
+    static const phys_t _DEBRIS_FADE;
+    /** Max debris bodies not fading out. */
+    static const int _DEBRIS_BUDGET;
+    /** Add a character with its player and HUD at an angle on the orbit. */
+    void addCharacter(phys_t angle);
+    /** Read the controls of player i, if the player has any. */
+    void bindPlayer(int i);
+    /**
+     * Make, add, remove and delete the graphics, in game_graphics.cxx, or
+     * game_headless.cxx for games that never have a screen.
+     */
+    void conceiveGraphics();
+    /** Give character i its graphics and mass indicator. */
+    void addGraphics(int i);
+    /** Take away the graphics of character i. */
+    void removeGraphics(int i);
+    void deleteGraphics();
+    /** Spread the mass indicators evenly over the top of the screen. */
+    void layoutMassIndicators();
+    /**
+     * Act on the players' input and the CPU players' plans, and record
+     * both for the planner.
+     */
+    void applyInputs(phys_t dt);
+    /** Keep the debris around the living characters. */
+    void updateFocus();
     /** Number of players. */
     int numPlayers_;
     /** Number of AIs. */
@@ -63,24 +164,44 @@ private:
     std::vector<AstroBody*> planets_;
     BackgroundModifier* backgroundModifier_;
     Camera* camera_;
+    CharacterController* controller_;
+    DebrisManager* debris_;
     std::vector<Character*> characters_;
     std::vector<CharacterGraphic*> characterGraphics_;
     ColorModifier* planetColour_;
     GameUniverse* universe_;
     GLuint tex_;
+    /** Textures of this game's graphics. */
+    TextureLoader* textures_;
+    /** Colours given to characters so far. */
+    int colours_;
+    /** Font of the mass indicator labels. */
+    char font_[256];
     GraphicFixture* planetFixture_;
     Material* matCharBody_, * matCharHead_, * matCharLimbs_,
         * matCharLimbsOff_, * matPlanet_;
     std::vector<Label*> massIndicatorLabels_;
     std::vector<MassIndicator*> massIndicators_;
     std::vector<MassIndicatorGraphic*> massIndicatorGfx_;
-    Circle<phys_t>* planetCircle_;
+    Terrain<phys_t>* planetTerrain_;
     std::vector<Player*> players_;
+    /** Changes of players so far, to tell snapshots from before them. */
+    int generation_;
+    /** Sends the players their input. */
+    InputRouter router_;
+    /** CPU players, who play the last characters, and their planner. */
+    std::vector<CpuPlayer*> cpus_;
+    Planner* planner_;
+    /**
+     * Actions the players hold as their events come in, and the actions of
+     * every character as of the last step, while there are CPU players.
+     */
+    std::vector<StepInput> captured_, inputs_;
     std::vector<PositionModifier*> massIndicatorPosMods_;
     Screen* screen_;
     StackGraphic* scene_, * foreground_;
     Sprite* backgroundSprite_;
-    TestDisk* planetDisk_;
+    TerrainGraphic* planetGraphic_;
 };
 
 #endif /* GAME_HXX_ */
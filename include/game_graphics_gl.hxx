@@ -31,6 +31,7 @@
 #include "menu.hxx"
 #include "physics.hxx"
 #include "screen_element.hxx"
+#include "snapshot.hxx"
 
 // We should make prototypes for all the classes or solve the problems that
 // cause the need for them in the first place. This looks a bit silly Lulzy
@@ -40,8 +41,7 @@ class Camera;
 class GraphicFixture: public GraphicModifier {
 public:
     GraphicFixture(Body* body);
-    void begin();
-    void end();
+    void modify(DrawState& state);
 private:
     GraphicFixture(const GraphicFixture&);
     GraphicFixture& operator=(const GraphicFixture&);
@@ -51,19 +51,28 @@ private:
 class ColorModifier: public GraphicModifier {
 public:
     ColorModifier(const float* color);
-    void begin();
-    void end();
+    void modify(DrawState& state);
 private:
     ColorModifier(const ColorModifier&);
     ColorModifier& operator=(const ColorModifier&);
     const float* color_;
 };
 
+/** Scales the opacity of the current colour. */
+class FadeModifier: public GraphicModifier {
+public:
+    FadeModifier(const float* fade);
+    void modify(DrawState& state);
+private:
+    FadeModifier(const FadeModifier&);
+    FadeModifier& operator=(const FadeModifier&);
+    const float* fade_;
+};
+
 class BackgroundModifier: public GraphicModifier {
 public:
     BackgroundModifier(Camera* camera);
-    void begin();
-    void end();
+    void modify(DrawState& state);
 private:
     BackgroundModifier(const BackgroundModifier&);
     BackgroundModifier& operator=(const BackgroundModifier&);
@@ -74,8 +83,9 @@ class PositionModifier: public GraphicModifier {
 public:
     PositionModifier(int position, int num, bool horizontalP,
             float offset = 0.0);
-    void begin();
-    void end();
+    void modify(DrawState& state);
+    /** Move to another of num evenly distributed positions. */
+    void setPosition(int position, int num);
 private:
     bool horizontalP_;
     int position_, num_;
@@ -85,13 +95,11 @@ private:
 class SizeModifier: public GraphicModifier {
 public:
     SizeModifier(Shape<phys_t>* shape);
-    void begin();
-    void end();
-    void scale();
+    void modify(DrawState& state);
 private:
     SizeModifier(const SizeModifier&);
     SizeModifier& operator=(const SizeModifier&);
-    Circle<phys_t>* shape_;
+    Shape<phys_t>* shape_;
 };
 
 class StackGraphic: public Graphic {
@@ -101,7 +109,7 @@ public:
     void addGraphic(Graphic* g, std::size_t index = -1);
     /** Removes a graphic from the stack. */
     std::size_t removeGraphic(Graphic* g);
-    void doDraw();
+    void doDraw(const DrawState& state);
 private:
     std::vector<Graphic*> graphics_;
 };
@@ -109,7 +117,7 @@ private:
 class Sprite: public Graphic {
 public:
     Sprite(GLuint texture, GLfloat w, GLfloat h);
-    void doDraw();
+    void doDraw(const DrawState& state);
 private:
     GLuint texture_;
     GLfloat w_, h_;
@@ -136,7 +144,7 @@ public:
     InputFieldGraphic(const char* face, ScreenElement* logic);
     ~InputFieldGraphic();
     char* getText();
-    void doDraw();
+    void doDraw(const DrawState& state);
     void setFace(const char* face);
     void setText();
 private:
@@ -155,7 +163,7 @@ private:
     int size_;
     /** The actual TTF_Font. */
     TTF_Font* font_;
-    void drawShadow();
+    void drawShadow(const DrawState& state);
     void make();
 };
 
@@ -168,7 +176,7 @@ public:
     char* getText();
     GLfloat getHeight();
     GLfloat getWidth();
-    void doDraw();
+    void doDraw(const DrawState& state);
     void setFace(const char* face);
     void setSize(int size);
     void setText(const char* text);
@@ -187,19 +195,20 @@ private:
     int size_;
     /** The actual TTF_Font. */
     TTF_Font* font_;
-    void drawShadow();
+    void drawShadow(const DrawState& state);
     void make();
 };
 
 class Disk: public Graphic {
 public:
     Disk(GLfloat r, int n);
-    void doDraw();
+    void doDraw(const DrawState& state);
 private:
     GLfloat r_;
     int n_;
-    GLuint displayList_;
-    void makeDisplayList();
+    /** The triangles, made once. */
+    std::vector<GLfloat> triangles_;
+    void makeTriangles();
 };
 
 class TestDisk: public StackGraphic {
@@ -211,12 +220,25 @@ private:
     Disk disk_, square_;
 };
 
+/** A terrain's outline, filled with triangles made once. */
+class TerrainGraphic: public Graphic {
+public:
+    TerrainGraphic(Terrain<phys_t>* terrain);
+    void doDraw(const DrawState& state);
+private:
+    TerrainGraphic(const TerrainGraphic&);
+    TerrainGraphic& operator=(const TerrainGraphic&);
+    Terrain<phys_t>* terrain_;
+    std::vector<GLfloat> triangles_;
+    void makeTriangles();
+};
+
 class MassIndicatorGraphic: public ScreenGraphic {
 public:
     MassIndicatorGraphic(GLfloat width, GLfloat height, MassIndicator* logic,
             Label* label = NULL);
     Label* const label;
-    void doDraw();
+    void doDraw(const DrawState& state);
 private:
     MassIndicatorGraphic(const MassIndicatorGraphic&);
     MassIndicatorGraphic& operator=(const MassIndicatorGraphic&);
@@ -229,7 +251,7 @@ public:
     ~ButtonGraphic();
     /** The button's label if any. */
     Label* const label;
-    void doDraw();
+    void doDraw(const DrawState& state);
 private:
     ButtonGraphic(const ButtonGraphic&);
     ButtonGraphic& operator=(const ButtonGraphic&);
@@ -256,7 +278,7 @@ class MenuGraphic: public Graphic {
 public:
     MenuGraphic(Menu* menu);
     ~MenuGraphic();
-    void doDraw();
+    void doDraw(const DrawState& state);
 private:
     MenuGraphic(const MenuGraphic&);
     MenuGraphic& operator=(const MenuGraphic&);
@@ -268,23 +290,57 @@ private:
     std::vector<Label*> labels_;
 };
 
+/**
+ * Loads each texture a game uses once. The textures are deleted with the
+ * loader, so it must not outlive the screen's GL context.
+ */
 class TextureLoader {
 public:
-    /** Get singleton. */
-    static TextureLoader* getInstance();
+    TextureLoader();
+    ~TextureLoader();
     /** Get a texture if file is loaded, make a new one if not loaded. */
     GLuint getTexture(const char* filename);
-protected:
-    TextureLoader();
 private:
+    TextureLoader(const TextureLoader&);
+    TextureLoader& operator=(const TextureLoader&);
     /** Load a texture from file. */
     GLuint loadTexture(const char* filename, bool premultiply);
-    /** The singleton. */
-    static TextureLoader* _instance_;
     /** Loaded textures. */
     std::map<std::string, GLuint> loaded_;
 };
 
+/**
+ * Triangles on their way to the screen, gathered into flat arrays and sent
+ * in one call for each run of the same texture and drawing mode. Graphics
+ * add their triangles already transformed, in the order they are drawn.
+ */
+class DrawBatch {
+public:
+    DrawBatch();
+    /**
+     * Use texture, or none if 0, in premultiplied or plain drawing mode
+     * for the triangles added next. Colours are always given plain.
+     */
+    void setTexture(GLuint texture, bool premul);
+    /**
+     * Add the rectangle (-w, -h) to (w, h), moved by (dx, dy), with the
+     * whole texture on it.
+     */
+    void addRectangle(const DrawState& state, const GLfloat* colour,
+            GLfloat w, GLfloat h, GLfloat dx = 0, GLfloat dy = 0);
+    /** Add n untextured triangles, given as x, y pairs. */
+    void addTriangles(const DrawState& state, const GLfloat* colour,
+            const GLfloat* points, int n);
+    /** Send the triangles to GL. */
+    void flush();
+private:
+    void addVertex(const DrawState& state, const GLfloat* colour, GLfloat x,
+            GLfloat y, GLfloat u, GLfloat v);
+    std::vector<GLfloat> vertices_, texCoords_, colours_;
+    GLuint texture_;
+    bool premul_;
+};
+
 class Screen: EventHandler {
 public:
     static const int _DM_FRONT_TO_BACK = 1, _DM_PREMUL = 2, _DM_SMOOTH = 4;
@@ -302,6 +358,8 @@ public:
     void setDrawingMode(int mode, int mask = -1, bool update = true);
     int getDrawingMode();
     void updateDrawingMode();
+    /** Get the batch that graphics are drawn through. */
+    DrawBatch* getBatch();
     bool handle(const SDL_Event& event);
 protected:
     Screen();
@@ -317,6 +375,7 @@ private:
     /** The surface pointer for SetVideoMode. */
     static SDL_Surface* _surface_;
     int drawingMode_;
+    DrawBatch batch_;
     static bool initialize();
 };
 
@@ -331,10 +390,10 @@ public:
     void setTargetState(state2p target);
     void setTargetRadius(GLfloat target);
     void setTargetRotation(GLfloat target, GLfloat speed = 1);
-    /** Rotate and translate OpenGL matrix. */
-    void apply();
-    void begin();
-    void end();
+    /** Rotate, scale and translate from the world to the screen. */
+    void modify(DrawState& state);
+    void save(Snapshot& s);
+    void restore(Snapshot& s);
 private:
     /** Pos and desired pos. */
     state2p state_, targetState_;
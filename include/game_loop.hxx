@@ -24,18 +24,27 @@
 #include <SDL/SDL.h>
 #include "game.hxx"
 #include "menu.hxx"
+#include "game_server.hxx"
+#include "net_session.hxx"
+#include "state_stream.hxx"
 #include "event_code.hxx"
+#include "event_queue.hxx"
 
 class GameLoop {
 public:
-    /** Number of steps simulated per second. */
-    static const double _STEPS_PER_SECOND = 600;
+    /**
+     * Number of steps simulated per second. The universe subdivides steps
+     * further where needed.
+     */
+    static const double _STEPS_PER_SECOND = 150;
     /** Max frames per second. */
     static const double _MAX_FPS = 200;
-    /** Number of simulation steps between each event update. */
-    static const int _EVENT_INTERVAL = 20;
     GameLoop();
     ~GameLoop();
+    /** Play new games over the network. */
+    void setNetwork(const NetConfig& net);
+    /** Stream the games to a Unix socket at path. */
+    bool setStream(const char* path);
     int run();
 private:
     GameLoop(const GameLoop&);
@@ -46,12 +55,18 @@ private:
     EventCode activeInput_;
     Screen* screen_;
     Game* limbsOff_;
+    bool networked_;
+    NetConfig net_;
+    NetSession* session_;
+    GameClient* client_;
+    StateStream* stream_;
     InputFieldGraphic* inputFieldGraphic_;
     Menu menu_;
     int prevWidth_, prevHeight_;
-    Uint8* keystate_;
-    unsigned int stepCounter_;
-    bool handleEvents();
+    EventQueue events_;
+    void handleEvent(SDL_Event& event);
+    /** Connect the new game to the peers or the server. */
+    void startSession();
 };
 
 #endif /* GAME_LOOP_HXX_ */
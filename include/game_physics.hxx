@@ -22,36 +22,116 @@
 #define GAME_PHYSICS_HXX_
 
 #include <vector>
+#include "collision_handler.hxx"
+#include "gravity_tree.hxx"
+#include "handle_table.hxx"
 #include "physics.hxx"
+#include "snapshot.hxx"
 
 class Character;
 class Universe;
 
+/** A ray, or a segment if length is finite. */
+struct RayQuery {
+    vector2p origin;
+    /** Unit direction. */
+    vector2p dir;
+    phys_t length;
+    /** Collision group whose bodies are ignored, or -1 for none. */
+    int ignoreGroup;
+    /** Whether the ray passes through the small bodies, hitting planets. */
+    bool planetsOnly;
+};
+
+struct RayHit {
+    /** Distance to the hit along the ray, or infinity if nothing was hit. */
+    phys_t t;
+    /** Surface normal at the hit. */
+    vector2p normal;
+    /** The body hit, or NULL. */
+    Body* body;
+};
+
 class SmallBody: public Body {
 public:
     SmallBody(state2p s, phys_t mass, phys_t orientation, phys_t av,
             phys_t moi, Shape<phys_t>* shape, Material* material,
             int collisionGroup);
+    /** Bodies in the same collision group do not collide with each other. */
+    void setCollisionGroup(int group);
 protected:
-    virtual bool interact(class AstroBody* bvz, double dt, vector2p& p,
-            vector2p& im);
+    /**
+     * Aim a ray from the body at planet b, to be cast along with the other
+     * bodies' before they interact with their primaries. Returns false to
+     * cast none and not interact.
+     */
+    virtual bool probe(class AstroBody* b, RayQuery& q);
+    /** Interact with planet b, given what the body's ray hit. */
+    virtual bool interact(class AstroBody* b, const RayHit& hit, double dt,
+            vector2p& p, vector2p& im);
 private:
-    void applyImpulseAndRewind(vector2p impulse, vector2p pos, phys_t dt,
-            phys_t fraction);
+    /**
+     * Apply an impulse at the given time and extrapolate to the span's end.
+     *
+     * @param h substep length.
+     * @param time time of the impulse, in substeps since the step start.
+     */
+    void applyImpulseAndRewind(vector2p impulse, vector2p pos, phys_t h,
+            phys_t time);
     void updateState(phys_t dt);
     void setDeltaState(int i, vector2p a);
     bodystate getNextState(phys_t dt);
+    /** Interpolate the state at a substep within the current span. */
+    bodystate getStateAt(int sub);
+    /** Get the next state from the closed-form orbit around b. */
+    bodystate getOrbitState(class AstroBody* b, phys_t dt);
+    /** Whether the body is only affected by its primary's gravity. */
+    bool isFreeFlying();
+    /** Save the body, referring to its material and primary by index. */
+    void save(Snapshot& s, const std::vector<Material*>& materials,
+            const std::vector<class AstroBody*>& planets);
+    void restore(Snapshot& s, const std::vector<Material*>& materials,
+            const std::vector<class AstroBody*>& planets);
     state2p ds_[4];
     bodystate nextState_;
     int collisionGroup_;
+    KeplerOrbit orbit_;
+    /** Planet pulling hardest on the body, which orbit_ goes around. */
+    class AstroBody* primary_;
+    /** Whether nextState_ follows orbit_ undisturbed. */
+    bool orbiting_;
+    /** Whether an enabled link is attached to the body. */
+    bool bound_;
+    /** Whether the body interacted with a planet during the last step. */
+    bool interacting_;
+    /** Whether the body came near another body during the last step. */
+    bool crowded_;
+    /** Whether the body follows its orbit during this step. */
+    bool freeFlying_;
+    /** Number of substeps per integration step, and start of current one. */
+    int span_, spanStart_;
     friend class GameUniverse;
+    friend class LinkSolver;
 };
 
 class AstroBody: public Body {
 public:
     const phys_t gm;
-    AstroBody(phys_t gm, phys_t moi, phys_t av, Shape<phys_t>* shape,
-            Material* material);
+    AstroBody(vector2p position, phys_t gm, phys_t moi, phys_t av,
+            Shape<phys_t>* shape, Material* material);
+    /** Get the radius of the surface in direction d from the centre. */
+    phys_t getSurfaceRadius(vector2p d);
+    /** Get the outward surface normal in direction d from the centre. */
+    vector2p getSurfaceNormal(vector2p d);
+    /**
+     * Find where the ray from o along the unit vector d enters the surface.
+     * Sets t to the distance there and n to the surface normal. Returns
+     * false if the ray misses, or starts beneath the surface.
+     */
+    bool castRay(vector2p o, vector2p d, phys_t& t, vector2p& n);
+private:
+    /** Refinements of the circle a ray is cast against on terrain. */
+    static const int _RAY_ITERATIONS = 3;
     friend class GameUniverse;
 };
 
@@ -59,29 +139,192 @@ class Link {
 public:
     virtual ~Link() { }
     Link(SmallBody* a, SmallBody* b);
-    virtual void update(phys_t dt, class GameUniverse* u) = 0;
+    /**
+     * Add the link's springs to a solver, to be solved with all the others.
+     * Returns false if the link is updated on its own instead.
+     */
+    virtual bool attach(class LinkSolver* s);
+    /** Remove the springs the link added to a solver. */
+    virtual void detach(class LinkSolver* s);
+    /**
+     * Point the link back at a solver whose restored state holds its springs
+     * again, as after restoring a snapshot taken while it was attached.
+     */
+    virtual void resume(class LinkSolver* s);
+    /** Update a link that is not attached to a solver. */
+    virtual void update(phys_t dt, class GameUniverse* u);
+    /** Whether the link currently affects its bodies. */
+    virtual bool isEnabled();
+    /** Fastest rate, in 1/s, at which the link changes its bodies' motion. */
+    virtual phys_t getRate();
 protected:
     SmallBody* const a_;
     SmallBody* const b_;
 private:
     Link(const Link&);
     Link& operator=(const Link&);
+    friend class GameUniverse;
+};
+
+/**
+ * Damped springs, each pulling a body b towards a pose fixed to a body a.
+ * The springs are stored as flat arrays and solved in one pass: the
+ * bodies' states are gathered, every impulse is computed in one loop over
+ * the arrays, and the impulses are scattered back to the bodies.
+ */
+class LinkSolver {
+public:
+    LinkSolver();
+    /** Add an enabled spring targeting a's centre. */
+    Handle add(SmallBody* a, SmallBody* b, phys_t lStiff, phys_t lDamp,
+            phys_t aStiff, phys_t aDamp);
+    void remove(Handle h);
+    int getNumSprings();
+    /** A removed spring reads as disabled, and ignores being set. */
+    bool isEnabled(Handle h);
+    void setEnabled(Handle h, bool enabled);
+    /** Set the target position and rotor of the spring, relative to a. */
+    void setTarget(Handle h, vector2p position, vector2p rotor);
+    /** Solve the enabled springs whose span ends with substep sub. */
+    void update(int sub, phys_t h);
+    /** Save the springs, referring to their bodies by index in bodies. */
+    void save(Snapshot& s, const std::vector<SmallBody*>& bodies);
+    void restore(Snapshot& s, const std::vector<SmallBody*>& bodies);
+private:
+    LinkSolver(const LinkSolver&);
+    LinkSolver& operator=(const LinkSolver&);
+    /** Fastest rate, in 1/s, at which spring i changes its bodies' motion. */
+    phys_t getRate(int i);
+    /** Match the gathered arrays to the number of springs. */
+    void resizeGathered();
+    HandleTable springs_;
+    std::vector<SmallBody*> a_, b_;
+    std::vector<char> enabled_;
+    std::vector<phys_t> lStiff_, lDamp_, aStiff_, aDamp_;
+    /** Target position and rotor of b, relative to a. */
+    std::vector<phys_t> px_, py_, rx_, ry_;
+    /** Gathered states of a and b: position, velocity, rotor and av. */
+    std::vector<phys_t> ax_, ay_, avx_, avy_, arx_, ary_, aw_;
+    std::vector<phys_t> bx_, by_, bvx_, bvy_, brx_, bry_, bw_;
+    /** Time step of each spring, or 0 if it is not solved this substep. */
+    std::vector<phys_t> dt_;
+    /** Linear impulse on a, and angular impulses on a and b. */
+    std::vector<phys_t> imx_, imy_, ta_, tb_;
+    friend class GameUniverse;
+};
+
+/** A collision resolved during an update. */
+struct CollisionEvent {
+    Body* body[2];
+    /** Where the bodies touched. */
+    vector2p position;
+    /** Size of the impulse between them. */
+    phys_t impulse;
 };
 
 class GameUniverse: public Universe {
 public:
-    GameUniverse(AstroBody* planet);
+    GameUniverse();
     void update(phys_t dt);
-    void addBody(SmallBody* b);
-    void addLink(Link* l);
+    /** Add a planet. Planets do not move, but may spin. */
+    void addPlanet(AstroBody* p);
+    /**
+     * Add and remove bodies and links between updates. Remove the links
+     * joining a body before the body. Removing is O(1), but changes the
+     * order of the remaining bodies and links.
+     */
+    Handle addBody(SmallBody* b);
+    bool removeBody(Handle h);
+    Handle addLink(Link* l);
+    bool removeLink(Handle h);
+    /**
+     * Let snapshots refer to a material no body is made of yet, such as
+     * one bodies change to later. The materials of added bodies are known.
+     */
+    void addMaterial(Material* m);
+    /** Reserve room, so that adding up to this many does not allocate. */
+    void reserve(int bodies, int links);
     void applyImpulse(SmallBody* a, SmallBody* b, vector2p im, vector2p pos);
     void applyAngularImpulse(SmallBody* a, SmallBody* b, phys_t im);
+    /**
+     * Cast n rays against the planet surfaces and every small body, treating
+     * small bodies as their bounding circles. Bodies containing a ray's
+     * origin are not hit.
+     */
+    void castRays(const RayQuery* rays, RayHit* hits, int n);
+    /** Get the collisions resolved during the last update. */
+    const std::vector<CollisionEvent>& getCollisions();
+    /** Get the handler told of every collision in this universe. */
+    CollisionHandler* getCollisionHandler();
+    /** Get a collision group no other body in this universe was given. */
+    int newCollisionGroup();
+    /**
+     * Save the bodies, links and which of them are in the universe. They
+     * are referred to by index among all those the universe has held, so
+     * they must still exist when restoring.
+     */
+    void save(Snapshot& s);
+    void restore(Snapshot& s);
 private:
+    /**
+     * Distance a body must keep to other bodies and the planet surfaces to
+     * follow a closed-form orbit instead of being integrated.
+     */
+    static const phys_t _FREE_FLIGHT_CLEARANCE;
+    /**
+     * Max gravity of the other planets, relative to the primary's, for a
+     * body to follow a closed-form orbit around its primary.
+     */
+    static const phys_t _MAX_ORBIT_PERTURBATION;
+    /** Steps are split into up to 2^_MAX_RATE_LEVEL substeps. */
+    static const int _MAX_RATE_LEVEL = 2;
+    /** Max distance travelled in one integration step. */
+    static const phys_t _MAX_STEP_TRAVEL;
+    /** Max link rate times integration step length. */
+    static const phys_t _MAX_STEP_PHASE;
     GameUniverse(const GameUniverse&);
     GameUniverse& operator=(const GameUniverse&);
-    AstroBody* planet_;
+    /** Choose the span of every body for a step of substep length h. */
+    void updateRates(phys_t h);
+    /** Get the longest span keeping rate * span * h at most 1. */
+    int getSpan(phys_t rate, phys_t h);
+    /** Give two linked bodies the shortest of their spans and span. */
+    bool joinSpans(SmallBody* a, SmallBody* b, int span);
+    /** Compute the next state of a body after dt. */
+    void integrate(SmallBody* b, phys_t dt);
+    std::vector<AstroBody*> planets_;
     std::vector<SmallBody*> smallBodies_;
+    /**
+     * Every body, link and material the universe has held, in the order
+     * it first did, for snapshots to refer to them by index.
+     */
+    std::vector<SmallBody*> knownBodies_;
+    std::vector<Link*> knownLinks_;
+    std::vector<Material*> knownMaterials_;
+    HandleTable bodyHandles_;
     std::vector<Link*> links_;
+    /** Whether each link is attached to springs_, instead of on its own. */
+    std::vector<char> linkAttached_;
+    HandleTable linkHandles_;
+    LinkSolver springs_;
+    /** Quadtree over the planets, and whether it needs rebuilding. */
+    GravityTree gravity_;
+    bool gravityChanged_;
+    /** Planets found by the broad phase, kept to avoid reallocating. */
+    std::vector<AstroBody*> nearPlanets_;
+    /**
+     * Bounding circles of the small bodies, as flat arrays for
+     * intersectRayCircles. Kept to avoid reallocating on every query.
+     */
+    std::vector<phys_t> queryX_, queryY_, queryRr_, queryT_;
+    /** Rays of the bodies interacting this substep, and what they hit. */
+    std::vector<RayQuery> probes_;
+    std::vector<RayHit> probeHits_;
+    std::vector<SmallBody*> probeBodies_;
+    std::vector<CollisionEvent> collisions_;
+    CollisionHandler collisionHandler_;
+    /** Collision groups given out. */
+    int collisionGroups_;
 };
 
 class FixtureSpring: public Link {
@@ -89,15 +332,25 @@ public:
     FixtureSpring(SmallBody* a, SmallBody* b, phys_t lStiff, phys_t lDamp,
             phys_t aStiff, phys_t aDamp);
     void setEnabled(bool status);
+    bool isEnabled();
+    phys_t getRate();
     void setPosition(vector2p position);
     void setOrientation(phys_t orientation);
     state2p getTargetState();
-    void update(phys_t dt, GameUniverse* u);
+    bool attach(LinkSolver* s);
+    void detach(LinkSolver* s);
+    void resume(LinkSolver* s);
+    void save(Snapshot& s);
+    void restore(Snapshot& s);
 protected:
     bool enabled_;
     phys_t lStiff_, lDamp_, aStiff_, aDamp_;
     vector2p position_;
-    phys_t orientation_;
+    /** Target orientation of b relative to a, as a unit rotor. */
+    vector2p rotor_;
+    /** The solver holding the spring once attached, and its handle there. */
+    LinkSolver* solver_;
+    Handle handle_;
 };
 
 #endif /* GAME_PHYSICS_HXX_ */
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GAME_SERVER_HXX_
+#define GAME_SERVER_HXX_
+
+#include <vector>
+#include "game.hxx"
+#include "state_frame.hxx"
+#include "step_input.hxx"
+#include "udp_socket.hxx"
+
+/**
+ * Authoritative server for a headless game. Clients send the inputs of
+ * their players, and the server sends every client what can be seen of the
+ * game at a fixed tick rate, each frame coded as its changes from the last
+ * frame the client acknowledged.
+ */
+class GameServer {
+public:
+    /** Serve a game, sending a frame every tickInterval steps. */
+    GameServer(Game* game, int tickInterval);
+    /** Listen on a UDP port. Returns false on failure. */
+    bool open(unsigned short port);
+    /** Take the clients' inputs and advance one step. */
+    void update(phys_t dt);
+    int getNumClients();
+    /** Mean bytes sent to a client per tick, since the stats were reset. */
+    double getBytesPerClient();
+    /** Mean CPU seconds spent per tick, since the stats were reset. */
+    double getTickTime();
+    void resetStats();
+private:
+    GameServer(const GameServer&);
+    GameServer& operator=(const GameServer&);
+    /** Frames kept to code against. */
+    static const int _HISTORY = 32;
+    /** Steps of silence before a client is dropped. */
+    static const int _TIMEOUT = 750;
+    static const int _MAX_CLIENTS = 32;
+    struct Client {
+        sockaddr_in address;
+        /** Player the client controls, or -1 if only watching. */
+        int player;
+        /** Tick of the newest frame the client has, or -1 if none. */
+        int acked;
+        /** Sequence number of the newest input. */
+        unsigned int sequence;
+        /** Step last heard from. */
+        int heard;
+        StepInput input;
+    };
+    void receive();
+    void broadcast();
+    /** Get the frame of a tick, or NULL if no longer kept. */
+    StateFrame* findFrame(int tick);
+    Game* game_;
+    UdpSocket socket_;
+    int tickInterval_, step_;
+    std::vector<Client> clients_;
+    StateFrame frames_[_HISTORY];
+    std::vector<unsigned char> packet_;
+    /** Stats since reset. */
+    double bytes_, busy_;
+    int ticks_, clientTicks_;
+};
+
+/**
+ * Client of a game server. The game is not simulated here, only shown as
+ * the server sends it, a little in the past so that there is always a
+ * frame on each side to interpolate between.
+ */
+class GameClient {
+public:
+    GameClient(Game* game);
+    ~GameClient();
+    /** Connect to the server at host:port. Returns false on failure. */
+    bool connect(const char* address);
+    /** Send the local player's input, and show the game one step on. */
+    void update();
+private:
+    GameClient(const GameClient&);
+    GameClient& operator=(const GameClient&);
+    /** Frames kept to code against and interpolate between. */
+    static const int _HISTORY = 32;
+    /** Steps between inputs sent when nothing changes. */
+    static const int _RESEND = 10;
+    /** Frames the game is shown behind the newest. */
+    static const int _BEHIND = 2;
+    void receive();
+    void send();
+    /** Give the local player the controls, and nobody else any. */
+    void bindPlayer();
+    Game* game_;
+    UdpSocket socket_;
+    sockaddr_in server_;
+    /** Player controlled here, as told by the server, or -1. */
+    int player_;
+    /** Players in the game, and player_, when the controls were given. */
+    int numBound_, bound_;
+    StateFrame frames_[_HISTORY];
+    /** Next slot of frames_ to fill, and the newest tick received. */
+    int next_, newest_;
+    /** Steps between the frames the server sends, or 0 if not known. */
+    int tickInterval_;
+    /** Tick shown now, or negative before the first frame. */
+    double time_;
+    StateFrame shown_;
+    /** Actions the local player holds now, and as last sent. */
+    StepInput capture_, sent_;
+    unsigned int sequence_;
+    int sinceSent_;
+    /** Whether a frame has arrived since the last input was sent. */
+    bool received_;
+};
+
+#endif /* GAME_SERVER_HXX_ */
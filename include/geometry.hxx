@@ -21,6 +21,7 @@
 #ifndef GEOMETRY_HXX_
 #define GEOMETRY_HXX_
 
+#include <vector>
 #include "template_math.hxx"
 
 #define PI (3.141592653589793)
@@ -30,6 +31,8 @@ template<typename T>
 struct vector2 {
     T x, y;
     static vector2<T> fromAngle(T angle);
+    /** Get the unit rotor for an angle, avoiding sin and cos if small. */
+    static vector2<T> fromSmallAngle(T angle);
     T& operator[](unsigned int i);
     const T& operator[](unsigned int i) const;
     const vector2<T> operator()(const T x0, const T y0);
@@ -50,12 +53,17 @@ struct vector2 {
     T angle() const;
     const vector2<T> unit() const;
     const vector2<T>& norm();
+    /** Normalise a vector that is already close to unit length. */
+    const vector2<T>& renorm();
     const vector2<T> rotated(vector2<T> u) const;
     const vector2<T>& rotate(vector2<T> u);
+    /** Rotate by the inverse of the unit rotor u. */
+    const vector2<T> unrotated(vector2<T> u) const;
 };
 
+/** NUM_SHAPETYPE is a length. */
 enum ShapeType {
-    CIRCLE, RECTANGLE
+    CIRCLE, RECTANGLE, CAPSULE, TERRAIN, NUM_SHAPETYPE
 };
 
 template<typename T>
@@ -65,6 +73,8 @@ public:
     ShapeType getType() {
         return type_;
     }
+    /** Get the radius of the smallest circle around the shape's centre. */
+    virtual T getBoundingRadius() = 0;
 protected:
     Shape(ShapeType type) :
             type_(type) { }
@@ -83,10 +93,104 @@ public:
     void setRadius(T radius) {
         radius_ = radius;
     }
+    T getBoundingRadius() {
+        return radius_;
+    }
 protected:
     T radius_;
 };
 
+/** A box centred on the body, with its width along the body's x axis. */
+template<typename T>
+class Rectangle: public Shape<T> {
+public:
+    Rectangle(T width, T height) :
+            Shape<T>(RECTANGLE),
+            halfWidth_(width / 2),
+            halfHeight_(height / 2) { }
+    T getHalfWidth() {
+        return halfWidth_;
+    }
+    T getHalfHeight() {
+        return halfHeight_;
+    }
+    T getBoundingRadius() {
+        return sqrt<T> (halfWidth_ * halfWidth_ + halfHeight_ * halfHeight_);
+    }
+protected:
+    T halfWidth_, halfHeight_;
+};
+
+/**
+ * All points within radius of a segment centred on the body, lying along
+ * the body's x axis.
+ */
+template<typename T>
+class Capsule: public Shape<T> {
+public:
+    Capsule(T length, T radius) :
+            Shape<T>(CAPSULE),
+            halfLength_(length / 2),
+            radius_(radius) { }
+    T getHalfLength() {
+        return halfLength_;
+    }
+    T getRadius() {
+        return radius_;
+    }
+    T getBoundingRadius() {
+        return halfLength_ + radius_;
+    }
+protected:
+    T halfLength_, radius_;
+};
+
+/**
+ * Radial heightfield centred on the body. The surface radius is sampled at
+ * equal angles counterclockwise from the body's x axis, and interpolated
+ * linearly between samples, so any direction is looked up in O(1).
+ */
+template<typename T>
+class Terrain: public Shape<T> {
+public:
+    /** Make terrain from a loaded list of surface radii. */
+    Terrain(const std::vector<T>& radii);
+    /**
+     * Generate rolling hills of up to amplitude around radius, as a sum of
+     * harmonics with random phases drawn from seed.
+     */
+    Terrain(T radius, T amplitude, int samples, unsigned int seed);
+    int getNumSamples() {
+        return radii_.size();
+    }
+    /** Get the surface point of sample i. */
+    vector2<T> getPoint(int i) {
+        return points_[i];
+    }
+    T getMinRadius() {
+        return min_;
+    }
+    T getBoundingRadius() {
+        return max_;
+    }
+    /** Get the position of unit vector u in samples, in [0, samples). */
+    T getIndex(vector2<T> u);
+    /** Get the surface radius in the direction of unit vector u. */
+    T getRadius(vector2<T> u);
+    /** Get the outward surface normal in the direction of unit vector u. */
+    vector2<T> getNormal(vector2<T> u);
+protected:
+    /** Compute the sample points and bounds from radii_. */
+    void init();
+    /** Split u's index into a sample and the fraction towards the next. */
+    void locate(vector2<T> u, int& i, T& f);
+    std::vector<T> radii_;
+    std::vector<vector2<T> > points_;
+    /** Samples per radian. */
+    T scale_;
+    T min_, max_;
+};
+
 /**
  * Calculate intersection between a line and a circle.
  *
@@ -29,6 +29,17 @@ inline vector2<T> vector2<T>::fromAngle(T angle) {
     return v;
 }
 
+template<typename T>
+inline vector2<T> vector2<T>::fromSmallAngle(T angle) {
+    T aa = angle * angle;
+    if (aa > T(0.0625))
+        return fromAngle(angle);
+    // Taylor series, accurate to about 1e-9 within the range.
+    vector2 v = { 1 - aa / 2 * (1 - aa / 12 * (1 - aa / 30)),
+            angle * (1 - aa / 6 * (1 - aa / 20 * (1 - aa / 42))) };
+    return v;
+}
+
 template<typename T>
 inline T& vector2<T>::operator[](unsigned int i) {
     return *(&x + i);
@@ -48,32 +59,38 @@ inline const vector2<T> vector2<T>::operator()(const T x0, const T y0) {
 
 template<typename T>
 inline const vector2<T> vector2<T>::operator-() const {
-    return vector2<T> ()(-x, -y);
+    vector2<T> r = { -x, -y };
+    return r;
 }
 
 template<typename T>
 inline const vector2<T> vector2<T>::operator~() const {
-    return vector2<T> ()(-y, x);
+    vector2<T> r = { -y, x };
+    return r;
 }
 
 template<typename T>
 inline const vector2<T> vector2<T>::operator+(const vector2<T>& v) const {
-    return vector2<T> ()(x + v.x, y + v.y);
+    vector2<T> r = { x + v.x, y + v.y };
+    return r;
 }
 
 template<typename T>
 inline const vector2<T> vector2<T>::operator-(const vector2<T>& v) const {
-    return vector2<T> ()(x - v.x, y - v.y);
+    vector2<T> r = { x - v.x, y - v.y };
+    return r;
 }
 
 template<typename T>
 inline const vector2<T> vector2<T>::operator*(const T f) const {
-    return vector2<T> ()(x * f, y * f);
+    vector2<T> r = { x * f, y * f };
+    return r;
 }
 
 template<typename T>
 inline const vector2<T> vector2<T>::operator/(const T d) const {
-    return vector2<T> ()(x / d, y / d);
+    vector2<T> r = { x / d, y / d };
+    return r;
 }
 
 template<typename T>
@@ -136,6 +153,12 @@ inline const vector2<T>& vector2<T>::norm() {
     return operator=(unit());
 }
 
+template<typename T>
+inline const vector2<T>& vector2<T>::renorm() {
+    // One Newton step towards 1 / length.
+    return operator*=((3 - squared()) / 2);
+}
+
 template<typename T>
 inline const vector2<T> vector2<T>::rotated(vector2<T> u) const {
     return vector2<T> (*this).rotate(u);
@@ -147,6 +170,12 @@ inline const vector2<T>& vector2<T>::rotate(vector2<T> u) {
     return *this;
 }
 
+template<typename T>
+inline const vector2<T> vector2<T>::unrotated(vector2<T> u) const {
+    vector2<T> r = { x * u.x + y * u.y, y * u.x - x * u.y };
+    return r;
+}
+
 template<typename T>
 bool intersectLineCircle(vector2<T> a, vector2<T> b, T rr, T& t1, T& t2) {
     vector2<T> d = b - a;
@@ -161,4 +190,87 @@ bool intersectLineCircle(vector2<T> a, vector2<T> b, T rr, T& t1, T& t2) {
     return true;
 }
 
+template<typename T>
+Terrain<T>::Terrain(const std::vector<T>& radii) :
+        Shape<T>(TERRAIN),
+        radii_(radii),
+        points_(),
+        scale_(0),
+        min_(0),
+        max_(0) {
+    init();
+}
+
+template<typename T>
+Terrain<T>::Terrain(T radius, T amplitude, int samples, unsigned int seed) :
+        Shape<T>(TERRAIN),
+        radii_(samples, radius),
+        points_(),
+        scale_(0),
+        min_(0),
+        max_(0) {
+    // Harmonic k has weight 1/k, and the weights are scaled to sum to one.
+    const int HARMONICS = max(1, min(16, samples / 8));
+    T phase[16], sum = 0;
+    for (int k = 1; k <= HARMONICS; ++k) {
+        seed = seed * 1103515245u + 12345u;
+        phase[k - 1] = (seed >> 16) * (2 * PI / 65536);
+        sum += T(1) / k;
+    }
+    for (int i = 0; i < samples; ++i) {
+        T a = i * (2 * PI / samples), h = 0;
+        for (int k = 1; k <= HARMONICS; ++k)
+            h += sin<T> (k * a + phase[k - 1]) / k;
+        radii_[i] += amplitude * h / sum;
+    }
+    init();
+}
+
+template<typename T>
+void Terrain<T>::init() {
+    int n = radii_.size();
+    scale_ = n / (2 * PI);
+    points_.resize(n);
+    min_ = max_ = radii_[0];
+    for (int i = 0; i < n; ++i) {
+        points_[i] = vector2<T>::fromAngle(i / scale_) * radii_[i];
+        min_ = min(min_, radii_[i]);
+        max_ = max(max_, radii_[i]);
+    }
+}
+
+template<typename T>
+T Terrain<T>::getIndex(vector2<T> u) {
+    T t = FastMath::atan2<T> (u.y, u.x) * scale_;
+    return t < 0 ? t + radii_.size() : t;
+}
+
+template<typename T>
+void Terrain<T>::locate(vector2<T> u, int& i, T& f) {
+    T t = getIndex(u);
+    i = (int) t;
+    f = t - i;
+    if (i >= (int) radii_.size())
+        i -= radii_.size();
+}
+
+template<typename T>
+T Terrain<T>::getRadius(vector2<T> u) {
+    int i;
+    T f;
+    locate(u, i, f);
+    T r0 = radii_[i], r1 = radii_[i + 1 < (int) radii_.size() ? i + 1 : 0];
+    return r0 + (r1 - r0) * f;
+}
+
+template<typename T>
+vector2<T> Terrain<T>::getNormal(vector2<T> u) {
+    int i;
+    T f;
+    locate(u, i, f);
+    T r0 = radii_[i], r1 = radii_[i + 1 < (int) radii_.size() ? i + 1 : 0];
+    // The surface r(a) u(a) has tangent r' u + r ~u, so r u - r' ~u is normal.
+    return (u * (r0 + (r1 - r0) * f) - ~u * ((r1 - r0) * scale_)).unit();
+}
+
 #endif /* GEOMETRY_INL_HXX_ */
@@ -23,29 +23,51 @@
 
 #include <vector>
 
+/**
+ * Where and how a graphic is drawn, as its modifiers leave it: an affine
+ * transform to GL coordinates, and a colour. Graphics work these out as
+ * they are drawn, so GL's matrices and colour are never touched.
+ */
+struct DrawState {
+    /** Maps (x, y) to (m[0] x + m[2] y + m[4], m[1] x + m[3] y + m[5]). */
+    float m[6];
+    float colour[4];
+    /** Set the identity transform and opaque white. */
+    void reset();
+    /**
+     * Transform by t, laid out as m, before the current transform, as GL
+     * multiplies its matrices.
+     */
+    void transform(const float* t);
+    void translate(float x, float y);
+    void scale(float x, float y);
+    /** Rotate anticlockwise by degrees. */
+    void rotate(float degrees);
+    /** Transform the point (x, y) into out. */
+    void map(float x, float y, float* out) const;
+};
+
 /** Graphic modifier. Modifies how a graphic is drawn. */
 class GraphicModifier {
 public:
     virtual ~GraphicModifier();
-    virtual void begin() = 0;
-    virtual void end() = 0;
+    /** Change the state the graphic is drawn in. */
+    virtual void modify(DrawState& state) = 0;
 };
 
 class Graphic {
 public:
     Graphic();
     virtual ~Graphic() = 0;
-    /** Draws the graphic without modifiers. */
-    virtual void doDraw() = 0;
-    /** Draws the graphic with all its modifiers applied. */
+    /** Draws the graphic in a state with its modifiers applied. */
+    virtual void doDraw(const DrawState& state) = 0;
+    /** Draws the graphic with all its modifiers applied to parent. */
+    void draw(const DrawState& parent);
+    /** Draws the graphic on its own, and sends it to the screen. */
     void draw();
     /** Appends a modifier to the list of modifiers. */
     void addModifier(GraphicModifier* modifier);
 protected:
-    /** Add modifiers to a graphic. */
-    void beginModifiers();
-    /** Remove modifiers from a graphic. */
-    void endModifiers();
     std::vector<GraphicModifier*> modifiers_;
 };
 
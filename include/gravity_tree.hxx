@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GRAVITY_TREE_HXX_
+#define GRAVITY_TREE_HXX_
+
+#include <vector>
+#include "physics.hxx"
+
+class AstroBody;
+
+/**
+ * Barnes-Hut quadtree over the astro bodies. Distant groups of bodies pull
+ * as a single point mass at their centre of mass, so gravity costs about
+ * O(log n) per evaluation. The bodies must not move between builds.
+ */
+class GravityTree {
+public:
+    GravityTree();
+    /** Rebuild the tree over the given bodies. */
+    void build(const std::vector<AstroBody*>& bodies);
+    /** Get the gravitational acceleration at p. */
+    vector2p getAcceleration(vector2p p) const;
+    /** Get the body whose gravity is strongest at p, or NULL if none. */
+    AstroBody* getStrongest(vector2p p) const;
+    /** Append the bodies whose bounding circles come within r of p. */
+    void getNear(vector2p p, phys_t r, std::vector<AstroBody*>& near) const;
+private:
+    /**
+     * Max ratio of a node's size to its distance for the node to be
+     * treated as a point mass.
+     */
+    static const phys_t _THETA;
+    /** Max depth, bounding the recursion on coincident bodies. */
+    static const int _MAX_DEPTH = 24;
+    struct Node {
+        /** Centre of mass and total gm of the bodies in the node. */
+        vector2p centre;
+        phys_t gm;
+        /** Side length of the node's square. */
+        phys_t size;
+        /** Radius around centre enclosing the bounding circles. */
+        phys_t reach;
+        /** Bodies [first, last) of bodies_ lie in the node. */
+        int first, last;
+        /** Indices of the child nodes, or 0 for none. */
+        int child[4];
+    };
+    /** Build the node for bodies [first, last) in the given square. */
+    int build(int first, int last, vector2p centre, phys_t half, int depth);
+    void accumulate(int k, vector2p p, vector2p& a) const;
+    void findStrongest(int k, vector2p p, AstroBody*& best,
+            phys_t& pull) const;
+    void findNear(int k, vector2p p, phys_t r,
+            std::vector<AstroBody*>& near) const;
+    std::vector<AstroBody*> bodies_;
+    std::vector<Node> nodes_;
+};
+
+#endif /* GRAVITY_TREE_HXX_ */
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HANDLE_TABLE_HXX_
+#define HANDLE_TABLE_HXX_
+
+#include <vector>
+
+class Snapshot;
+
+/**
+ * Reference to an element of a HandleTable. It goes stale when the element
+ * is removed, even if its slot is reused. Generations start at 1, so a
+ * zeroed handle refers to nothing.
+ */
+struct Handle {
+    int slot;
+    unsigned int generation;
+};
+
+/**
+ * Generational handles to the elements of a dense array kept by the owner.
+ * Removing an element moves the last one into its place, so the array
+ * stays dense, and adding and removing are O(1):
+ *
+ *     int i = table.remove(h);
+ *     items[i] = items.back();
+ *     items.pop_back();
+ */
+class HandleTable {
+public:
+    HandleTable();
+    /** Get a handle to a new element at the end of the dense array. */
+    Handle add();
+    /** Get the dense index of the element, or -1 if the handle is stale. */
+    int find(Handle h) const;
+    /**
+     * Remove the element, and get the index the owner must move its last
+     * element to, or -1 if the handle is stale.
+     */
+    int remove(Handle h);
+    int size() const;
+    /** Reserve room for n elements, so that adding does not allocate. */
+    void reserve(int n);
+    void save(Snapshot& s);
+    void restore(Snapshot& s);
+private:
+    struct Slot {
+        int index;
+        unsigned int generation;
+    };
+    std::vector<Slot> slots_;
+    /** Slot of each element of the dense array. */
+    std::vector<int> owners_;
+    std::vector<int> free_;
+};
+
+#endif /* HANDLE_TABLE_HXX_ */
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INPUT_ROUTER_HXX_
+#define INPUT_ROUTER_HXX_
+
+#include <vector>
+#include "action.hxx"
+#include "event_handler.hxx"
+
+class Player;
+
+/**
+ * Sends input to the players. A single table maps each key, and each
+ * button and axis of each joystick, to the player and action bound to it,
+ * so an event costs one lookup however many players and controllers there
+ * are. Each game has its own.
+ */
+class InputRouter: public EventHandler {
+public:
+    /** NUM_INPUTKIND is a length. */
+    enum InputKind {
+        KEY,
+        JOY_BUTTON,
+        JOY_AXIS,
+        NUM_INPUTKIND
+    };
+    InputRouter();
+    /** Send the event to the player bound to it, if any. */
+    bool handle(const SDL_Event& event);
+    /**
+     * Bind an input to an action of a player, replacing any binding it
+     * had. Device is the joystick, and is ignored for keys.
+     */
+    void bind(InputKind kind, int device, int code, Player* player,
+            ActionType action);
+    /** Unbind every input bound to the player. */
+    void unbind(Player* player);
+    /** Unbind every input. */
+    void clear();
+private:
+    InputRouter(const InputRouter&);
+    InputRouter& operator=(const InputRouter&);
+    /** Number of buttons, and of axes, given each joystick. */
+    static const int _JOY_CODES = 256;
+    struct Target {
+        Player* player;
+        ActionType action;
+    };
+    /**
+     * Get the index of an input in table_: the keys first, then the
+     * buttons and axes of joystick 0, of joystick 1 and so on. Returns -1
+     * for an input that cannot be bound.
+     */
+    static int getIndex(InputKind kind, int device, int code);
+    /** Grows to the highest input bound. */
+    std::vector<Target> table_;
+};
+
+#endif /* INPUT_ROUTER_HXX_ */
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NET_SESSION_HXX_
+#define NET_SESSION_HXX_
+
+#include <string>
+#include <vector>
+#include "game.hxx"
+#include "snapshot.hxx"
+#include "step_input.hxx"
+#include "udp_socket.hxx"
+
+/** How to connect a networked game. */
+struct NetConfig {
+    /** UDP port to listen on. */
+    unsigned short port;
+    /** The other peers, as host:port. */
+    std::vector<std::string> peers;
+    /** Server to play on instead, as host:port, or empty for none. */
+    std::string server;
+    /** Player controlled on this machine. */
+    int localPlayer;
+    /** Steps between an input and the step it is applied to. */
+    int delay;
+    /** Steps of latency of a loopback peer, or -1 for none. */
+    int loopbackLatency;
+    /** Share of the loopback peer's packets that are lost. */
+    double loopbackLoss;
+};
+
+/**
+ * Stand-in for a remote peer, for testing on one machine. It plays one
+ * player with scripted input, and talks to a session over the local socket,
+ * holding back its packets for a number of steps and dropping some.
+ */
+class LoopbackPeer {
+public:
+    LoopbackPeer(int player, int latency, double loss);
+    /** Open a socket to a session on this machine. */
+    bool open(unsigned short sessionPort);
+    unsigned short getPort();
+    /** Advance one step. */
+    void update();
+private:
+    LoopbackPeer(const LoopbackPeer&);
+    LoopbackPeer& operator=(const LoopbackPeer&);
+    struct Delayed {
+        int due;
+        std::vector<unsigned char> data;
+    };
+    UdpSocket socket_;
+    int player_, latency_;
+    double loss_;
+    sockaddr_in session_;
+    /**
+     * Steps taken, steps of input the session has, and steps of the
+     * session's input received.
+     */
+    int frame_, acked_, received_;
+    unsigned int seed_;
+    std::vector<StepInput> inputs_;
+    std::vector<Delayed> queue_;
+};
+
+/**
+ * Peer-to-peer rollback networking. Only the players' inputs are sent, one
+ * per step. Inputs that have not arrived are predicted to be the last that
+ * did. When a prediction turns out wrong, the game is restored to the step
+ * of the mistake and simulated forward again, so every peer ends up with
+ * the same game.
+ */
+class NetSession {
+public:
+    /** Play a game with the local player on this machine. */
+    NetSession(Game* game, int localPlayer, int delay);
+    ~NetSession();
+    /** Listen on a UDP port. Returns false on failure. */
+    bool open(unsigned short port);
+    /** Add the peer at host:port. Returns false if it cannot be found. */
+    bool addPeer(const char* address);
+    /** Add a loopback peer playing the given player. */
+    bool addLoopbackPeer(int player, int latency, double loss);
+    /** Advance one step. Returns false if waiting for the other peers. */
+    bool update(phys_t dt);
+    /** Get the steps simulated again after mispredictions, in total. */
+    int getResimulated();
+    /** Max steps to roll back, and to run ahead of any peer. */
+    static const int _MAX_ROLLBACK = 32;
+private:
+    /** Steps of history kept for inputs and snapshots. */
+    static const int _HISTORY = 64;
+    /** Max input delay, in steps. */
+    static const int _MAX_DELAY = 15;
+    NetSession(const NetSession&);
+    NetSession& operator=(const NetSession&);
+    struct Peer {
+        sockaddr_in address;
+        /** Player the peer controls, or -1 until heard from. */
+        int player;
+        /** Steps of local input the peer has. */
+        int acked;
+    };
+    StepInput& at(int player, int frame);
+    void receive();
+    void send();
+    /** Predict the missing inputs, and simulate one step. */
+    void simulate(int frame, phys_t dt);
+    Game* game_;
+    int local_, delay_;
+    UdpSocket socket_;
+    std::vector<Peer> peers_;
+    LoopbackPeer* loopback_;
+    /** Next step to simulate. */
+    int frame_;
+    /** Inputs of every player, _HISTORY steps each. */
+    std::vector<StepInput> inputs_;
+    /** Steps of input received from each player. */
+    std::vector<int> confirmed_;
+    /** First step simulated with a wrong prediction, or frame_ if none. */
+    int rollbackFrom_;
+    /** Game state before each step, _HISTORY steps back. */
+    Snapshot snapshots_[_HISTORY];
+    /** Actions the local player holds now. */
+    StepInput capture_;
+    int resimulated_;
+};
+
+#endif /* NET_SESSION_HXX_ */
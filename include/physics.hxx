@@ -25,7 +25,12 @@
 #include <list>
 #include "geometry.hxx"
 
+/** Configure with --enable-float-physics for single-precision physics. */
+#if PHYS_FLOAT
+typedef float phys_t;
+#else
 typedef double phys_t;
+#endif
 
 const float G = 6.67384e-11;
 
@@ -64,9 +69,9 @@ typedef state2<phys_t> state2p;
 
 struct bodystate {
     state2p l;
-    state1p a;
-    const bodystate operator+(const bodystate& s) const;
-    const bodystate operator*(const phys_t f) const;
+    /** Orientation as a unit rotor (cos, sin). */
+    vector2p r;
+    phys_t av;
 };
 
 class Material {
@@ -107,7 +112,10 @@ protected:
 
 class Body: public Mass {
 public:
+    /** Get the orientation angle. Prefer getRotor. */
     phys_t getOrientation();
+    /** Get the orientation as a unit rotor (cos, sin). */
+    vector2p getRotor();
     phys_t getAngularVelocity();
     phys_t getMomentOfInertia();
     Material* getMaterial();
@@ -117,9 +125,14 @@ public:
     vector2p getMomentumAt(vector2p p, vector2p vp);
     vector2p getVelocityAt(vector2p p);
     bodystate getBodyState();
+    /**
+     * Put the body at rest in a pose from outside the simulation, such as
+     * one received over the network.
+     */
+    void setPose(vector2p position, vector2p rotor);
     virtual ~Body();
 protected:
-    phys_t orientation_;
+    vector2p rotor_;
     phys_t av_;
     phys_t moi_;
     Shape<phys_t>* shape_;
@@ -161,10 +174,38 @@ private:
     std::list<Collision> collisions_;
 };
 
+/**
+ * Closed-form two-body orbit about a fixed point mass.
+ *
+ * Propagates a state relative to the attracting body using the universal
+ * variable formulation, so elliptic, parabolic and hyperbolic orbits are all
+ * handled without integration error.
+ */
+class KeplerOrbit {
+public:
+    KeplerOrbit();
+    /** Start a new orbit from a state relative to the attracting body. */
+    void setEpoch(state2p s, phys_t gm);
+    /** Advance the orbit by dt and return the new relative state. */
+    state2p advance(phys_t dt);
+private:
+    /** Relative state at the epoch. */
+    state2p epoch_;
+    phys_t gm_, sqrtGm_;
+    /** Radius, radial velocity and inverse semi-major axis at the epoch. */
+    phys_t r0_, vr0_, alpha_;
+    /** Time since the epoch, universal anomaly and radius at that time. */
+    phys_t time_, chi_, r_;
+};
+
 phys_t momentInertia(phys_t mass, phys_t radius, phys_t dist = 1.0);
 
-bool collide(Body* a, Body* b, bodystate& na, bodystate& nb, phys_t& t,
-        vector2p& p, vector2p& n);
+/**
+ * Find the first contact between two bodies moving linearly from sa and sb
+ * to na and nb. On contact, na and nb are set to the states at time t.
+ */
+bool collide(Body* a, Body* b, bodystate sa, bodystate sb, bodystate& na,
+        bodystate& nb, phys_t& t, vector2p& p, vector2p& n);
 
 vector2p bounce1(Body* a, Body* b, vector2p& pa, vector2p pb, vector2p n,
         phys_t restitution, phys_t friction, phys_t rr, phys_t addVel);
@@ -172,6 +213,15 @@ vector2p bounce1(Body* a, Body* b, vector2p& pa, vector2p pb, vector2p n,
 vector2p bounce2(Body* a, Body* b, vector2p& pa, vector2p& pb, vector2p n,
         phys_t restitution, phys_t friction, phys_t rr, phys_t addVel);
 
+/**
+ * Intersect the ray from o along the unit vector d with n circles, given as
+ * arrays of centres and squared radii. Sets t[i] to the distance to where
+ * the ray enters circle i, or to infinity if it misses or starts inside.
+ * Runs several circles at a time with SSE where available.
+ */
+void intersectRayCircles(vector2p o, vector2p d, const phys_t* cx,
+        const phys_t* cy, const phys_t* rr, int n, phys_t* t);
+
 #include "physics_inl.hxx"
 
 #endif /* PHYSICS_HXX_ */
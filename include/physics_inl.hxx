@@ -32,27 +32,32 @@ inline const state1<T> state1<T>::operator()(const T p0, const T v0) {
 
 template<typename T>
 inline const state1<T> state1<T>::operator-() const {
-    return state1<T> ()(-p, -v);
+    state1<T> r = { -p, -v };
+    return r;
 }
 
 template<typename T>
 inline const state1<T> state1<T>::operator+(const state1<T> &s) const {
-    return state1<T> ()(p + s.p, v + s.v);
+    state1<T> r = { p + s.p, v + s.v };
+    return r;
 }
 
 template<typename T>
 inline const state1<T> state1<T>::operator-(const state1<T> &s) const {
-    return state1<T> ()(p - s.p, v - s.v);
+    state1<T> r = { p - s.p, v - s.v };
+    return r;
 }
 
 template<typename T>
 inline const state1<T> state1<T>::operator*(const T f) const {
-    return state1<T> ()(p * f, v * f);
+    state1<T> r = { p * f, v * f };
+    return r;
 }
 
 template<typename T>
 inline const state1<T> state1<T>::operator/(const T d) const {
-    return state1<T> ()(p / d, v / d);
+    state1<T> r = { p / d, v / d };
+    return r;
 }
 
 template<typename T>
@@ -83,27 +88,32 @@ inline const state2<T> state2<T>::operator()(const T x, const T y, const T vx,
 
 template<typename T>
 inline const state2<T> state2<T>::operator-() const {
-    return state2<T> ()(-p, -v);
+    state2<T> r = { -p, -v };
+    return r;
 }
 
 template<typename T>
 inline const state2<T> state2<T>::operator+(const state2<T>& s) const {
-    return state2<T> ()(p + s.p, v + s.v);
+    state2<T> r = { p + s.p, v + s.v };
+    return r;
 }
 
 template<typename T>
 inline const state2<T> state2<T>::operator-(const state2<T>& s) const {
-    return state2<T> ()(p - s.p, v - s.v);
+    state2<T> r = { p - s.p, v - s.v };
+    return r;
 }
 
 template<typename T>
 inline const state2<T> state2<T>::operator*(const T f) const {
-    return state2<T> ()(p * f, v * f);
+    state2<T> r = { p * f, v * f };
+    return r;
 }
 
 template<typename T>
 inline const state2<T> state2<T>::operator/(const T d) const {
-    return state2<T> ()(p / d, v / d);
+    state2<T> r = { p / d, v / d };
+    return r;
 }
 
 template<typename T>
@@ -130,16 +140,6 @@ inline const state2<T>& state2<T>::operator/=(const T d) {
     return *this;
 }
 
-inline const bodystate bodystate::operator+(const bodystate& s) const {
-    bodystate r = { l + s.l, a + s.a };
-    return r;
-}
-
-inline const bodystate bodystate::operator*(const phys_t f) const {
-    bodystate r = { l * f, a * f };
-    return r;
-}
-
 inline Material::Material(phys_t stiffness, phys_t toughness) :
         stiffness_(stiffness),
         toughness_(toughness) {
@@ -210,7 +210,7 @@ inline void Mass::applyImpulse(vector2p i) {
 inline Body::Body(state2p s, phys_t mass, phys_t orientation, phys_t av, phys_t
         moi, Shape<phys_t>* shape, Material* material, bool immovable) :
         Mass(s, mass, immovable),
-        orientation_(orientation),
+        rotor_(vector2p::fromAngle(orientation)),
         av_(av),
         moi_(moi),
         shape_(shape),
@@ -221,7 +221,11 @@ inline Body::~Body() {
 }
 
 inline phys_t Body::getOrientation() {
-    return orientation_;
+    return rotor_.angle();
+}
+
+inline vector2p Body::getRotor() {
+    return rotor_;
 }
 
 inline phys_t Body::getAngularVelocity() {
@@ -260,10 +264,17 @@ inline vector2p Body::getVelocityAt(vector2p p) {
 }
 
 inline bodystate Body::getBodyState() {
-    bodystate r = { s_, { orientation_, av_ } };
+    bodystate r = { s_, rotor_, av_ };
     return r;
 }
 
+inline void Body::setPose(vector2p position, vector2p rotor) {
+    s_.p = position;
+    s_.v(0, 0);
+    rotor_ = rotor;
+    av_ = 0;
+}
+
 inline void Body::applyAngularImpulse(phys_t i) {
     av_ += i / moi_;
 }
@@ -275,8 +286,8 @@ inline void Body::applyImpulseAt(vector2p i, vector2p p) {
 
 inline void Body::setBodyState(bodystate s) {
     s_ = s.l;
-    orientation_ = s.a.p;
-    av_ = s.a.v;
+    rotor_ = s.r;
+    av_ = s.av;
 }
 
 inline bool Collision::operator<(const Collision& b) const {
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PLANNER_HXX_
+#define PLANNER_HXX_
+
+#include <vector>
+#include <SDL/SDL.h>
+#include "game.hxx"
+#include "snapshot.hxx"
+#include "step_input.hxx"
+
+/**
+ * Chooses the actions of the characters played by the computer. Each
+ * worker thread keeps a headless copy of the game in step with it, by
+ * replaying the input every character was given, and plans by trying
+ * inputs on its copy for a short while ahead. A worker thinks for at most
+ * _BUDGET milliseconds per plan, publishing the best input found so far as
+ * it goes. The game never waits for a plan: it acts on the latest.
+ */
+class Planner {
+public:
+    /**
+     * Plan for characters first to numCharacters - 1 of a game just
+     * conceived with numCharacters characters.
+     */
+    Planner(int numCharacters, int first);
+    ~Planner();
+    /** Record the actions every character holds for the next step. */
+    void record(const StepInput* inputs, phys_t dt);
+    /** Get the latest plan for character i. */
+    StepInput getPlan(int i);
+    int getNumThreads();
+private:
+    Planner(const Planner&);
+    Planner& operator=(const Planner&);
+    /** Steps looked ahead. */
+    static const int _HORIZON = 40;
+    /** Steps between plans. */
+    static const int _REPLAN = 15;
+    /** Milliseconds a worker thinks per plan, shared by its characters. */
+    static const int _BUDGET = 60;
+    /** Steps replayed by every worker before they are forgotten. */
+    static const int _TRIM = 256;
+    struct Worker {
+        Planner* planner;
+        SDL_Thread* thread;
+        Game* game;
+        Snapshot snapshot;
+        /** Characters planned for. */
+        std::vector<int> characters;
+        /** Steps replayed, and steps since the last plan. */
+        int done, sincePlan;
+        /** Plans made, to vary which inputs are tried first. */
+        int round;
+        /** Actions each character of game holds. */
+        std::vector<StepInput> held;
+        /** Steps taken from the planner to replay. */
+        std::vector<phys_t> steps;
+        std::vector<StepInput> inputs;
+    };
+    static int run(void* worker);
+    /** Wait for steps and replay them. Returns false when stopping. */
+    bool replay(Worker* w);
+    /** Plan for the worker's characters within the budget. */
+    void plan(Worker* w);
+    /** Score the game for character i. Higher is better. */
+    phys_t evaluate(Game* game, int i);
+    int numCharacters_, first_;
+    SDL_mutex* mutex_;
+    SDL_cond* recorded_;
+    bool stopping_;
+    /** Lengths of the steps not yet replayed by every worker, from base_. */
+    std::vector<phys_t> steps_;
+    std::vector<StepInput> inputs_;
+    int base_;
+    std::vector<StepInput> plans_;
+    std::vector<Worker*> workers_;
+};
+
+#endif /* PLANNER_HXX_ */
@@ -23,22 +23,21 @@
 #include "actor.hxx"
 #include "action.hxx"
 #include "character.hxx"
-#include "event_handler.hxx"
+#include "step_input.hxx"
 
-class Player: public Actor, public EventHandler {
+/** A character played by a person. The InputRouter sends it the input. */
+class Player: public Actor {
 public:
     Player(Character* character);
-    /** Handle keyboard event. */
-    bool handle(const SDL_Event& event);
-    /** Bind key to action. */
-    void bindKey(SDLKey key, ActionType action);
-    void bindJoyAxis(Uint8 axis, ActionType action);
-    void bindJoyButton(Uint8 button, ActionType action);
+    /** Take input for an action. Value is as for Actor::act. */
+    bool input(ActionType action, double value);
+    /**
+     * Record the actions held into input instead of acting on them, or act
+     * again if input is NULL.
+     */
+    void setCapture(StepInput* input);
 private:
-    /** All bindindgs. */
-    ActionType keyBindings_[SDLK_LAST];
-    ActionType joyAxisBindings_[256];
-    ActionType joyButtonBindings_[256];
+    StepInput* capture_;
 };
 
 #endif /* PLAYER_HXX_ */
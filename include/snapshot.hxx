@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SNAPSHOT_HXX_
+#define SNAPSHOT_HXX_
+
+#include <vector>
+
+/**
+ * Flat copy of simulation state, read back in the order it was written.
+ * The buffer is kept between snapshots, so taking one every step does not
+ * allocate once it has grown to size. Objects are referred to by index in
+ * tables their owners keep, so a snapshot can only be restored into the
+ * world it was taken from.
+ */
+class Snapshot {
+public:
+    Snapshot();
+    /** Start a new snapshot, reusing the buffer. */
+    void clear();
+    template<typename T> void write(const T& v);
+    /** Write the length and elements of a vector of plain data. */
+    template<typename T> void write(const std::vector<T>& v);
+    /** Write p as its index in table, or -1 if it is NULL or not there. */
+    template<typename T> void writeIndex(T* p, const std::vector<T*>& table);
+    /** Write the length of v and the index in table of each element. */
+    template<typename T> void writeIndices(const std::vector<T*>& v,
+            const std::vector<T*>& table);
+    /**
+     * Start reading from the beginning. Returns false if the snapshot was
+     * taken by another version, or with another precision, or was cut
+     * short.
+     */
+    bool rewind();
+    template<typename T> void read(T& v);
+    /** Read a vector, reusing its storage if it has room. */
+    template<typename T> void read(std::vector<T>& v);
+    /** Read an index written by writeIndex, failing if it is not in table. */
+    template<typename T> void readIndex(T*& p, const std::vector<T*>& table);
+    /** Read indices written by writeIndices, reusing v's storage. */
+    template<typename T> void readIndices(std::vector<T*>& v,
+            const std::vector<T*>& table);
+    /** Whether every read so far was within the snapshot. */
+    bool isGood();
+    const char* getData();
+    int getSize();
+    /** Replace the snapshot, as with one loaded from elsewhere. */
+    void setData(const char* data, int size);
+    /** Reserve room for a snapshot of size bytes. */
+    void reserve(int size);
+private:
+    /** Bump whenever anything saves different fields. */
+    static const unsigned int _VERSION = 3;
+    struct Header {
+        unsigned int version;
+        unsigned int physSize;
+        /** Size of the whole snapshot, kept current as it is written. */
+        int size;
+    };
+    /** Make room for n more bytes. */
+    char* grow(int n);
+    /** Get n bytes to read, or NULL past the end. */
+    const char* take(int n);
+    std::vector<char> data_;
+    int size_, pos_;
+    bool good_;
+};
+
+#include "snapshot_inl.hxx"
+
+#endif /* SNAPSHOT_HXX_ */
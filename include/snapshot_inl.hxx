@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SNAPSHOT_INL_HXX_
+#define SNAPSHOT_INL_HXX_
+
+#include <string.h>
+#include "snapshot.hxx"
+
+template<typename T>
+inline void Snapshot::write(const T& v) {
+    memcpy(grow(sizeof(T)), &v, sizeof(T));
+}
+
+template<typename T>
+inline void Snapshot::write(const std::vector<T>& v) {
+    int n = v.size();
+    write(n);
+    if (n)
+        memcpy(grow(n * sizeof(T)), &v[0], n * sizeof(T));
+}
+
+template<typename T>
+inline void Snapshot::writeIndex(T* p, const std::vector<T*>& table) {
+    int i = table.size() - 1;
+    while (i >= 0 && (!p || table[i] != p))
+        --i;
+    write(i);
+}
+
+template<typename T>
+inline void Snapshot::writeIndices(const std::vector<T*>& v,
+        const std::vector<T*>& table) {
+    int n = v.size();
+    write(n);
+    for (int i = 0; i < n; ++i)
+        writeIndex(v[i], table);
+}
+
+template<typename T>
+inline void Snapshot::read(T& v) {
+    const char* p = take(sizeof(T));
+    if (p)
+        memcpy(&v, p, sizeof(T));
+}
+
+template<typename T>
+inline void Snapshot::read(std::vector<T>& v) {
+    int n = -1;
+    read(n);
+    const char* p = n >= 0 ? take(n * sizeof(T)) : NULL;
+    if (!p)
+        return;
+    v.resize(n);
+    if (n)
+        memcpy(&v[0], p, n * sizeof(T));
+}
+
+template<typename T>
+inline void Snapshot::readIndex(T*& p, const std::vector<T*>& table) {
+    int i = -2;
+    read(i);
+    if (i < -1 || i >= (int) table.size())
+        good_ = false;
+    if (good_)
+        p = i < 0 ? NULL : table[i];
+}
+
+template<typename T>
+inline void Snapshot::readIndices(std::vector<T*>& v,
+        const std::vector<T*>& table) {
+    int n = -1;
+    read(n);
+    if (n < 0 || n > size_ - pos_)
+        good_ = false;
+    if (!good_)
+        return;
+    v.resize(n);
+    for (int i = 0; i < n; ++i)
+        readIndex(v[i], table);
+}
+
+#endif /* SNAPSHOT_INL_HXX_ */
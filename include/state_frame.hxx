@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STATE_FRAME_HXX_
+#define STATE_FRAME_HXX_
+
+#include <vector>
+#include "physics.hxx"
+
+/**
+ * What can be seen of a game, quantised to integers so that frames can be
+ * compared and sent value by value: the planet's rotation, and for each
+ * character its flags, mass, and the position, rotation and opacity of
+ * each of its parts.
+ */
+class StateFrame {
+public:
+    /** Values before the first character, and for each character. */
+    static const int _HEADER_SIZE = 1, _CHARACTER_SIZE = 26;
+    /** Offsets in the values of a character, and of a part after PARTS. */
+    enum { FLAGS, MASS, PARTS };
+    enum { PART_X, PART_Y, PART_ANGLE, PART_FADE, PART_SIZE };
+    /** Bits of FLAGS. */
+    enum { DEAD = 1, FACING_LEFT = 2 };
+    StateFrame();
+    void resize(int numCharacters);
+    int getNumCharacters() const;
+    int getTick() const;
+    void setTick(int tick);
+    int getPlanetAngle() const;
+    void setPlanetAngle(int angle);
+    int* getCharacter(int i);
+    const int* getCharacter(int i) const;
+    /** Set to the frame t of the way from a to b, for drawing between. */
+    void interpolate(const StateFrame& a, const StateFrame& b, phys_t t);
+    /**
+     * Append the frame, coded as its changes from a base frame with as many
+     * characters, or in full if base is NULL.
+     */
+    void encode(const StateFrame* base, std::vector<unsigned char>& out)
+            const;
+    /**
+     * Decode a frame coded against base. Returns the bytes read, or -1 if
+     * the data is malformed or was coded against another base.
+     */
+    int decode(const StateFrame* base, const unsigned char* data, int size);
+    static int toPosition(phys_t x);
+    static phys_t fromPosition(int x);
+    /** Angles are in 1/65536 of a turn. */
+    static int toAngle(vector2p rotor);
+    static vector2p fromAngle(int angle);
+    static int toMass(phys_t m);
+    static phys_t fromMass(int m);
+    static int toFade(float f);
+    static float fromFade(int f);
+private:
+    /** Values of the position and mass units, and of full opacity. */
+    static const phys_t _POSITION_UNIT, _MASS_UNIT;
+    static const int _OPAQUE = 255;
+    /** Whether value i is an angle, which wraps around. */
+    static bool isAngle(int i);
+    int tick_;
+    std::vector<int> values_;
+};
+
+#endif /* STATE_FRAME_HXX_ */
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STATE_STREAM_HXX_
+#define STATE_STREAM_HXX_
+
+#include <string>
+#include <vector>
+#include "game.hxx"
+
+/**
+ * Live stream of the game for other programs, such as viewers, stat
+ * collectors and bots, over a Unix sequenced-packet socket. Readers
+ * connect to the socket and receive one packet per frame. Publishing never
+ * blocks: a reader that has not kept up misses frames.
+ *
+ * Every field of a frame is 32 bits and little-endian, u32 unsigned and
+ * f32 an IEEE 754 single, with angles in radians:
+ *
+ *     header     "LOST", u32 version, u32 frame, u32 step, u32 planets,
+ *                u32 characters, u32 collisions, u32 bytes in the frame
+ *     planet     f32 x, y, angle, radius
+ *     character  u32 flags (1 dead, 2 facing left), f32 mass, and for each
+ *                part f32 x, y, angle
+ *     collision  u32 body, u32 body, f32 x, y, impulse
+ *
+ * The collisions are those since the last frame. The parts of character i
+ * are bodies 6i to 6i + 5, in the order of Character::getBodies. Planet i
+ * is body 0x80000000 + i, and a body that is neither is 0xffffffff.
+ */
+class StateStream {
+public:
+    static const int _VERSION = 1;
+    StateStream();
+    ~StateStream();
+    /** Listen at path, replacing any socket there. */
+    bool open(const char* path);
+    /** Take note of the collisions of the step just simulated. */
+    void collect(Game* game);
+    /** Send the game as it is now to every reader with room for it. */
+    void publish(Game* game);
+    int getNumReaders();
+    /** Get the frames readers have missed for lack of room, in total. */
+    int getDropped();
+private:
+    StateStream(const StateStream&);
+    StateStream& operator=(const StateStream&);
+    /** Max collisions in a frame. The rest are left out. */
+    static const int _MAX_COLLISIONS = 256;
+    static const int _MAX_READERS = 16;
+    struct Collision {
+        unsigned int body[2];
+        float x, y, impulse;
+    };
+    /** Get the number of a body in the frame. */
+    unsigned int getBodyNumber(Game* game, Body* body);
+    void putU32(unsigned int v);
+    void putF32(float v);
+    int socket_;
+    std::string path_;
+    std::vector<int> readers_;
+    std::vector<Collision> collisions_;
+    std::vector<unsigned char> packet_;
+    unsigned int frame_, step_;
+    int dropped_;
+};
+
+#endif /* STATE_STREAM_HXX_ */
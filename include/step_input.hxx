@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STEP_INPUT_HXX_
+#define STEP_INPUT_HXX_
+
+#include "action.hxx"
+
+class Actor;
+
+/** The actions a player holds during one step, small enough to send. */
+struct StepInput {
+    /** Bit a is set while action a is held. */
+    unsigned short held;
+    /**
+     * Speeds of LEFT and RIGHT, in steps of 1/127. A negative speed moves
+     * the other way, as an axis bound to one direction does.
+     */
+    signed char left, right;
+    /** Hold or release an action. Value is as for Actor::act. */
+    void set(ActionType a, double value);
+    /** Make the actor act on what changed since the previous input. */
+    void apply(Actor* actor, const StepInput& previous) const;
+    bool operator==(const StepInput& i) const;
+    bool operator!=(const StepInput& i) const;
+};
+
+#endif /* STEP_INPUT_HXX_ */
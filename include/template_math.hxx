@@ -21,7 +21,9 @@
 #define TEMPLATE_MATH_HXX_
 
 #include <math.h>
+#include <stdint.h>
 #include <algorithm>
+#include <limits>
 
 template<typename T>
 T sqrt(T x);
@@ -56,6 +58,79 @@ T max(T x, T y);
 template<typename T>
 T clampmag(T x, T m);
 
+template<typename T>
+T exp2(T x);
+
+template<typename T>
+T log2(T x);
+
+template<typename T>
+T pow(T x, T y);
+
+/**
+ * Maths policy forwarding to libm. Interchangeable with FastMath, so that
+ * code can be written against either.
+ */
+struct ExactMath {
+    template<typename T>
+    static T sin(T x);
+    template<typename T>
+    static T cos(T x);
+    template<typename T>
+    static T atan2(T y, T x);
+    template<typename T>
+    static T exp2(T x);
+    template<typename T>
+    static T log2(T x);
+    template<typename T>
+    static T pow(T x, T y);
+    template<typename T>
+    static T rsqrt(T x);
+};
+
+/**
+ * Maths policy using polynomial approximations instead of libm. Meant for
+ * control code where errors around 1e-7 do not matter. The error bounds
+ * below hold for double and are checked by physics-bench. For float, the
+ * error is dominated by rounding.
+ */
+struct FastMath {
+    /** Absolute error below 1e-7 for |x| < 1e4. */
+    template<typename T>
+    static T sin(T x);
+    /** Absolute error below 1e-7 for |x| < 1e4. */
+    template<typename T>
+    static T cos(T x);
+    /** Absolute error below 2e-7. Returns 0 for the origin. */
+    template<typename T>
+    static T atan2(T y, T x);
+    /**
+     * Relative error below 1e-8 for |x| < 1000 while 2^x is normal. Flushes
+     * to 0 below the normal range and to infinity above it.
+     */
+    template<typename T>
+    static T exp2(T x);
+    /** Absolute error below 2e-9 for normal x > 0. */
+    template<typename T>
+    static T log2(T x);
+    /** Relative error below 1e-8 * (1 + |y log2(x)|) for normal x > 0. */
+    template<typename T>
+    static T pow(T x, T y);
+    /** Relative error below 1e-10 for x > 0 in the normal float range. */
+    template<typename T>
+    static T rsqrt(T x);
+private:
+    /**
+     * Multiply x > 0 by 2^n. Gives 0 if 2^n is below the normal range and
+     * infinity if it is above.
+     */
+    static float scale2(float x, int n);
+    static double scale2(double x, int n);
+    /** Split normal x > 0 into m * 2^n with m in [1, 2). */
+    static float split2(float x, int& n);
+    static double split2(double x, int& n);
+};
+
 #include "template_math_inl.hxx"
 
 #endif /* TEMPLATE_MATH_HXX_ */
@@ -152,4 +152,210 @@ inline T clampmag(T x, T m) {
     return max<T> (-m, min<T> (m, x));
 }
 
+template<>
+inline float exp2<float> (float x) {
+    return exp2f(x);
+}
+
+template<>
+inline double exp2<double> (double x) {
+    return exp2(x);
+}
+
+template<>
+inline float log2<float> (float x) {
+    return log2f(x);
+}
+
+template<>
+inline double log2<double> (double x) {
+    return log2(x);
+}
+
+template<>
+inline float pow<float> (float x, float y) {
+    return powf(x, y);
+}
+
+template<>
+inline double pow<double> (double x, double y) {
+    return pow(x, y);
+}
+
+template<typename T>
+inline T ExactMath::sin(T x) {
+    return ::sin<T> (x);
+}
+
+template<typename T>
+inline T ExactMath::cos(T x) {
+    return ::cos<T> (x);
+}
+
+template<typename T>
+inline T ExactMath::atan2(T y, T x) {
+    return ::atan2<T> (y, x);
+}
+
+template<typename T>
+inline T ExactMath::exp2(T x) {
+    return ::exp2<T> (x);
+}
+
+template<typename T>
+inline T ExactMath::log2(T x) {
+    return ::log2<T> (x);
+}
+
+template<typename T>
+inline T ExactMath::pow(T x, T y) {
+    return ::pow<T> (x, y);
+}
+
+template<typename T>
+inline T ExactMath::rsqrt(T x) {
+    return 1 / ::sqrt<T> (x);
+}
+
+inline float FastMath::scale2(float x, int n) {
+    if (n < -126)
+        return 0;
+    if (n > 127)
+        return std::numeric_limits<float>::infinity();
+    union {
+        float f;
+        uint32_t i;
+    } u;
+    u.i = (uint32_t) (n + 127) << 23;
+    return x * u.f;
+}
+
+inline double FastMath::scale2(double x, int n) {
+    if (n < -1022)
+        return 0;
+    if (n > 1023)
+        return std::numeric_limits<double>::infinity();
+    union {
+        double f;
+        uint64_t i;
+    } u;
+    u.i = (uint64_t) (n + 1023) << 52;
+    return x * u.f;
+}
+
+inline float FastMath::split2(float x, int& n) {
+    union {
+        float f;
+        uint32_t i;
+    } u;
+    u.f = x;
+    n = (int) (u.i >> 23) - 127;
+    u.i = (u.i & 0x007fffff) | 0x3f800000;
+    return u.f;
+}
+
+inline double FastMath::split2(double x, int& n) {
+    union {
+        double f;
+        uint64_t i;
+    } u;
+    u.f = x;
+    n = (int) (u.i >> 52) - 1023;
+    u.i = (u.i & 0x000fffffffffffffull) | 0x3ff0000000000000ull;
+    return u.f;
+}
+
+template<typename T>
+inline T FastMath::sin(T x) {
+    // Reduce to [-pi/2, pi/2] using sin(x - n pi) = (-1)^n sin(x).
+    long n = (long) (x * T(0.31830988618379067) + (x < 0 ? -0.5 : 0.5));
+    T r = x - n * T(3.141592653589793), rr = r * r;
+    // Taylor series. The first omitted term is below 6e-8.
+    r += r * rr * (T(-1.0 / 6) + rr * (T(1.0 / 120) + rr * (T(-1.0 / 5040) +
+            rr * (T(1.0 / 362880) + rr * T(-1.0 / 39916800)))));
+    return n & 1 ? -r : r;
+}
+
+template<typename T>
+inline T FastMath::cos(T x) {
+    return sin<T> (x + T(1.5707963267948966));
+}
+
+template<typename T>
+inline T FastMath::atan2(T y, T x) {
+    T ax = ::abs<T> (x), ay = ::abs<T> (y);
+    if (ax == 0 && ay == 0)
+        return 0;
+    // Reduce to atan(t) for t in [0, 1], then to |t| <= tan(pi / 8).
+    bool steep = ay > ax;
+    T t = steep ? ax / ay : ay / ax, a = 0;
+    if (t > T(0.41421356237309503)) {
+        t = (t - 1) / (t + 1);
+        a = T(0.78539816339744831);
+    }
+    // Taylor series. The first omitted term is below 1.3e-7.
+    T tt = t * t;
+    a += t + t * tt * (T(-1.0 / 3) + tt * (T(1.0 / 5) + tt * (T(-1.0 / 7) +
+            tt * (T(1.0 / 9) + tt * (T(-1.0 / 11) + tt * T(1.0 / 13))))));
+    if (steep)
+        a = T(1.5707963267948966) - a;
+    if (x < 0)
+        a = T(3.141592653589793) - a;
+    return y < 0 ? -a : a;
+}
+
+template<typename T>
+inline T FastMath::exp2(T x) {
+    // Keep n well within int; scale2 flushes what is out of range.
+    x = std::max(T(-2048), std::min(x, T(2048)));
+    // Split into 2^n * 2^f with |f| <= 1/2.
+    int n = (int) (x + (x < 0 ? -0.5 : 0.5));
+    T f = x - n;
+    // Taylor series of e^(f ln 2). The first omitted term is below 6e-9.
+    T r = 1 + f * (T(0.69314718055994531) + f * (T(0.24022650695910071) +
+            f * (T(0.055504108664821576) + f * (T(0.0096181291076284772) +
+            f * (T(0.0013333558146428443) + f * (T(0.00015403530393381606) +
+            f * T(1.5252733804059838e-05)))))));
+    return scale2(r, n);
+}
+
+template<typename T>
+inline T FastMath::log2(T x) {
+    // Split into 2^n * m with m in [sqrt(1/2), sqrt(2)).
+    int n;
+    T m = split2(x, n);
+    if (m > T(1.4142135623730951)) {
+        m *= T(0.5);
+        ++n;
+    }
+    // ln(m) = 2 atanh(s). Taylor series; the first omitted term is below
+    // 1e-9.
+    T s = (m - 1) / (m + 1), ss = s * s;
+    T l = s * (2 + ss * (T(2.0 / 3) + ss * (T(2.0 / 5) + ss * (T(2.0 / 7) +
+            ss * T(2.0 / 9)))));
+    return n + l * T(1.4426950408889634);
+}
+
+template<typename T>
+inline T FastMath::pow(T x, T y) {
+    return exp2<T> (y * log2<T> (x));
+}
+
+template<typename T>
+inline T FastMath::rsqrt(T x) {
+    // Initial guess within 3.5% from the float bit pattern, then three
+    // Newton steps.
+    union {
+        float f;
+        uint32_t i;
+    } u;
+    u.f = (float) x;
+    u.i = 0x5f3759df - (u.i >> 1);
+    T r = u.f, h = x * T(0.5);
+    r *= T(1.5) - h * r * r;
+    r *= T(1.5) - h * r * r;
+    r *= T(1.5) - h * r * r;
+    return r;
+}
+
 #endif /* TEMPLATE_MATH_INL_HXX_ */
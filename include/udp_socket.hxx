@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UDP_SOCKET_HXX_
+#define UDP_SOCKET_HXX_
+
+#include <netinet/in.h>
+
+/** Non-blocking UDP socket. POSIX only. */
+class UdpSocket {
+public:
+    UdpSocket();
+    ~UdpSocket();
+    /** Listen on a port, or any free port if 0. Returns false on failure. */
+    bool open(unsigned short port);
+    bool isOpen();
+    unsigned short getPort();
+    /** Receive a datagram. Returns its size, or -1 if none is waiting. */
+    int receive(unsigned char* data, int size, sockaddr_in* from);
+    void send(const unsigned char* data, int size, const sockaddr_in& to);
+    /** Look up host:port. Returns false if it cannot be found. */
+    static bool resolve(const char* address, sockaddr_in& a);
+    /** Get the address of a port on this machine. */
+    static sockaddr_in getLocalAddress(unsigned short port);
+    static bool isSameAddress(const sockaddr_in& a, const sockaddr_in& b);
+    /** Write and read unsigned 32-bit little-endian integers. */
+    static void putU32(unsigned char* p, unsigned int v);
+    static unsigned int getU32(const unsigned char* p);
+private:
+    UdpSocket(const UdpSocket&);
+    UdpSocket& operator=(const UdpSocket&);
+    int socket_;
+};
+
+#endif /* UDP_SOCKET_HXX_ */
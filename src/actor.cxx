@@ -22,3 +22,41 @@
 Actor::Actor(Character* character) :
     character_(character) {
 }
+
+bool Actor::act(ActionType action, double value) {
+    switch (action) {
+    case LEFT:
+        character_->moveLeft(value);
+        break;
+    case RIGHT:
+        character_->moveRight(value);
+        break;
+    case JUMP:
+        character_->jump(value);
+        break;
+    case CROUCH:
+        character_->crouch(value);
+        break;
+    case FIRE:
+        character_->fire(value);
+        break;
+    case LPUNCH:
+        character_->leftPunch(value);
+        break;
+    case RPUNCH:
+        character_->rightPunch(value);
+        break;
+    case LKICK:
+        character_->leftKick(value);
+        break;
+    case RKICK:
+        character_->rightKick(value);
+        break;
+    case SUICIDE:
+        character_->die();
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
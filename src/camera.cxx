@@ -57,25 +57,37 @@ void Camera::setTargetRotation(GLfloat target, GLfloat speed) {
 }
 
 void Camera::update(GLfloat deltaTime) {
-    GLfloat decay = pow(.1, deltaTime);
+    GLfloat decay = FastMath::pow<GLfloat> (.1, deltaTime);
     state_ = targetState_ * (1.0 - decay) + state_ * decay;
     state_.p += state_.v * deltaTime;
     radius_ = targetRadius_ * (1.0 - decay) + radius_ * decay;
     GLfloat diff = remainder((targetRotation_ - rotation_), 360.0);
-    rotation_ += (1.0 - pow(.1, rotationSpeed_ * deltaTime)) * diff;
+    rotation_ += (1.0 - FastMath::pow<GLfloat> (.1, rotationSpeed_ *
+            deltaTime)) * diff;
 }
 
-void Camera::apply() {
-    glRotatef(rotation_, 0.0, 0.0, -1.0);
-    glScalef(1.0 / radius_, 1.0 / radius_, 0.0);
-    glTranslatef(-state_.p.x, -state_.p.y, 0.0);
+void Camera::modify(DrawState& state) {
+    state.rotate(-rotation_);
+    state.scale(1.0 / radius_, 1.0 / radius_);
+    state.translate(-state_.p.x, -state_.p.y);
 }
 
-void Camera::begin() {
-    glPushMatrix();
-    apply();
+void Camera::save(Snapshot& s) {
+    s.write(state_);
+    s.write(targetState_);
+    s.write(radius_);
+    s.write(targetRadius_);
+    s.write(rotation_);
+    s.write(targetRotation_);
+    s.write(rotationSpeed_);
 }
 
-void Camera::end() {
-    glPopMatrix();
+void Camera::restore(Snapshot& s) {
+    s.read(state_);
+    s.read(targetState_);
+    s.read(radius_);
+    s.read(targetRadius_);
+    s.read(rotation_);
+    s.read(targetRotation_);
+    s.read(rotationSpeed_);
 }
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "character_controller.hxx"
+
+CharacterController::CharacterController() :
+        vel_(),
+        crouchCap_(),
+        characters_() {
+}
+
+Handle CharacterController::add() {
+    for (int a = 0; a < NUM_ACTIONTYPE; ++a) {
+        intention_[a].push_back(0.0);
+        power_[a].push_back(0.0);
+    }
+    vel_.push_back(0.0);
+    crouchCap_.push_back(0.0);
+    return characters_.add();
+}
+
+void CharacterController::remove(Handle c) {
+    int i = characters_.remove(c);
+    if (i < 0)
+        return;
+    std::vector<phys_t>* meters[NUM_ACTIONTYPE * 2 + 2];
+    for (int a = 0; a < NUM_ACTIONTYPE; ++a) {
+        meters[a * 2] = &intention_[a];
+        meters[a * 2 + 1] = &power_[a];
+    }
+    meters[NUM_ACTIONTYPE * 2] = &vel_;
+    meters[NUM_ACTIONTYPE * 2 + 1] = &crouchCap_;
+    for (int k = 0; k < NUM_ACTIONTYPE * 2 + 2; ++k) {
+        std::vector<phys_t>& m = *meters[k];
+        m[i] = m.back();
+        m.pop_back();
+    }
+}
+
+int CharacterController::getNumCharacters() {
+    return vel_.size();
+}
+
+bool CharacterController::getIntention(Handle c, ActionType a) {
+    int i = characters_.find(c);
+    return i >= 0 && intention_[a][i] != 0.0;
+}
+
+void CharacterController::setIntention(Handle c, ActionType a, bool state) {
+    int i = characters_.find(c);
+    if (i >= 0)
+        intention_[a][i] = state ? 1.0 : 0.0;
+}
+
+phys_t CharacterController::getPower(Handle c, ActionType a) {
+    int i = characters_.find(c);
+    return i >= 0 ? power_[a][i] : 0.0;
+}
+
+void CharacterController::setPower(Handle c, ActionType a, phys_t power) {
+    int i = characters_.find(c);
+    if (i >= 0)
+        power_[a][i] = power;
+}
+
+phys_t CharacterController::getVel(Handle c) {
+    int i = characters_.find(c);
+    return i >= 0 ? vel_[i] : 0.0;
+}
+
+void CharacterController::setVel(Handle c, phys_t vel) {
+    int i = characters_.find(c);
+    if (i >= 0)
+        vel_[i] = vel;
+}
+
+void CharacterController::setCrouchCap(Handle c, phys_t cap) {
+    int i = characters_.find(c);
+    if (i >= 0)
+        crouchCap_[i] = cap;
+}
+
+void CharacterController::update(phys_t dt) {
+    // The loops blend instead of branching, so that they vectorise.
+    const int n = vel_.size();
+    if (n == 0)
+        return;
+    phys_t decay = FastMath::pow<phys_t> (.2, dt), gain = 1 - decay;
+    // If crouching, raise the crouching power to the cap. If not crouching,
+    // easily uncrouch without jumping.
+    const phys_t* intention = &intention_[CROUCH][0];
+    phys_t* power = &power_[CROUCH][0];
+    const phys_t* cap = &crouchCap_[0];
+    for (int c = 0; c < n; ++c) {
+        phys_t on = 1.5 * gain + power[c] * decay, off = power[c] - 3.0 * dt,
+                top = cap[c];
+        on = on < top ? on : top;
+        off = off > 0.0 ? off : 0.0;
+        power[c] = off + (on - off) * intention[c];
+    }
+    // Cap jump power to 1.0 by forcejumping. If jumping, raise jump power.
+    // If not, set jump power to 0.
+    phys_t* jumping = &intention_[JUMP][0];
+    power = &power_[JUMP][0];
+    for (int c = 0; c < n; ++c) {
+        jumping[c] = power[c] < 1.0 ? jumping[c] : 0.0;
+        power[c] = (1.5 * gain + power[c] * decay) * jumping[c];
+    }
+    const ActionType punches[] = { LPUNCH, RPUNCH };
+    for (int i = 0; i < 2; ++i) {
+        intention = &intention_[punches[i]][0];
+        power = &power_[punches[i]][0];
+        for (int c = 0; c < n; ++c)
+            power[c] = (250.0 * gain + power[c] * decay) * intention[c];
+    }
+}
+
+void CharacterController::save(Snapshot& s) {
+    characters_.save(s);
+    for (int a = 0; a < NUM_ACTIONTYPE; ++a) {
+        s.write(intention_[a]);
+        s.write(power_[a]);
+    }
+    s.write(vel_);
+    s.write(crouchCap_);
+}
+
+void CharacterController::restore(Snapshot& s) {
+    characters_.restore(s);
+    for (int a = 0; a < NUM_ACTIONTYPE; ++a) {
+        s.read(intention_[a]);
+        s.read(power_[a]);
+    }
+    s.read(vel_);
+    s.read(crouchCap_);
+}
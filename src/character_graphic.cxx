@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2011, 2012, 2013 Alexander Berntsen <alexander@plaimi.net>
+ * Copyright (C) 2011, 2012 Stian Ellingsen <stian@plaimi.net>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "character.hxx"
+
+CharacterGraphic::CharacterGraphic(Character* c, TextureLoader* textures,
+        int colour) :
+        orientation_(c->getOrientation()),
+        c_(c),
+        bodyFixture_(&c->body_),
+        headFixture_(&c->head_),
+        footBackFixture_(&c->footBack_),
+        footFrontFixture_(&c->footFront_),
+        handBackFixture_(&c->handBack_),
+        handFrontFixture_(&c->handFront_),
+        bodyFade_(&c->fade_[0]),
+        headFade_(&c->fade_[1]),
+        footBackFade_(&c->fade_[2]),
+        footFrontFade_(&c->fade_[3]),
+        handBackFade_(&c->fade_[4]),
+        handFrontFade_(&c->fade_[5]),
+        bodyColor_(colour_),
+        scaler_(c->body_.getShape()),
+        bodyLeft_(textures->getTexture(PACKAGE_GFX_DIR
+                "character_body_left.png"), 1.0, 1.0),
+        bodyRight_(textures->getTexture(PACKAGE_GFX_DIR
+                "character_body_right.png"), 1.0, 1.0),
+        headLeft_(textures->getTexture(PACKAGE_GFX_DIR
+                "character_head_left.png"), 0.15, 0.15),
+        headRight_(textures->getTexture(PACKAGE_GFX_DIR
+                "character_head_right.png"), 0.15, 0.15),
+        footBack_(textures->getTexture(PACKAGE_GFX_DIR
+                "character_foot.png"), 0.075, 0.075),
+        footFront_(textures->getTexture(PACKAGE_GFX_DIR
+                "character_foot.png"), 0.075, 0.075),
+        handBack_(textures->getTexture(PACKAGE_GFX_DIR
+                "character_hand.png"), 0.1, 0.1),
+        handFront_(textures->getTexture(PACKAGE_GFX_DIR
+                "character_hand.png"), 0.1, 0.1),
+        body_(&bodyLeft_), head_(&headLeft_),
+        shown_(0x3f) {
+    int m = colour % 3, d = colour / 3, mm = d / 2 % 4, dd = d / 8;
+    for (int i = 0; i < 3; i++)
+        colour_[i] = (3 * ((m == i) ^ d & 1) ^ ((mm == i + 1) ^ dd & 1)) / 4.0;
+
+    bodyLeft_.addModifier(&scaler_);
+    bodyLeft_.addModifier(&bodyFixture_);
+    bodyLeft_.addModifier(&bodyColor_);
+    bodyLeft_.addModifier(&bodyFade_);
+    bodyRight_.addModifier(&scaler_);
+    bodyRight_.addModifier(&bodyFixture_);
+    bodyRight_.addModifier(&bodyColor_);
+    bodyRight_.addModifier(&bodyFade_);
+    headLeft_.addModifier(&headFixture_);
+    headLeft_.addModifier(&bodyColor_);
+    headLeft_.addModifier(&headFade_);
+    headRight_.addModifier(&headFixture_);
+    headRight_.addModifier(&bodyColor_);
+    headRight_.addModifier(&headFade_);
+    footBack_.addModifier(&footBackFixture_);
+    footBack_.addModifier(&bodyColor_);
+    footBack_.addModifier(&footBackFade_);
+    footFront_.addModifier(&footFrontFixture_);
+    footFront_.addModifier(&bodyColor_);
+    footFront_.addModifier(&footFrontFade_);
+    handBack_.addModifier(&handBackFixture_);
+    handBack_.addModifier(&bodyColor_);
+    handBack_.addModifier(&handBackFade_);
+    handFront_.addModifier(&handFrontFixture_);
+    handFront_.addModifier(&bodyColor_);
+    handFront_.addModifier(&handFrontFade_);
+    restack();
+}
+
+bool CharacterGraphic::updateOrientation() {
+    char orientation = c_->getOrientation();
+    if (orientation_ == orientation)
+        return false;
+    orientation_ = orientation;
+    return true;
+}
+
+ColorModifier* CharacterGraphic::getColourModifier() {
+    return &bodyColor_;
+}
+
+void CharacterGraphic::update() {
+    bool turned = updateOrientation();
+    if (turned) {
+        // Determine whether going left or right.
+        if (orientation_ == 'l') {
+            head_ = &headLeft_;
+            body_ = &bodyLeft_;
+        }
+        else {
+            head_ = &headRight_;
+            body_ = &bodyRight_;
+        }
+    }
+    if (updateShown() || turned)
+        restack();
+}
+
+bool CharacterGraphic::updateShown() {
+    int shown = 0;
+    for (int i = 0; i < 6; ++i)
+        shown |= (c_->fade_[i] > 0) << i;
+    if (shown_ == shown)
+        return false;
+    shown_ = shown;
+    return true;
+}
+
+void CharacterGraphic::restack() {
+    Sprite* all[] = { &handBack_, &footBack_, &bodyLeft_, &bodyRight_,
+            &headLeft_, &headRight_, &footFront_, &handFront_ };
+    for (int i = 0; i < 8; ++i)
+        removeGraphic(all[i]);
+    // Back to front, with the bits of the parts in shown_.
+    Sprite* parts[] = { &handBack_, &footBack_, body_, head_, &footFront_,
+            &handFront_ };
+    const int bits[] = { 4, 2, 0, 1, 3, 5 };
+    for (int i = 0; i < 6; ++i) {
+        if (shown_ >> bits[i] & 1)
+            addGraphic(parts[i]);
+    }
+}
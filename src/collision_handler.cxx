@@ -17,20 +17,13 @@
  * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "character.hxx"
 #include "collision_handler.hxx"
 
-CollisionHandler* CollisionHandler::_instance_ = NULL;
-
 CollisionHandler::CollisionHandler() :
         monitored_() {
 }
 
-CollisionHandler* CollisionHandler::getInstance() {
-    if (!_instance_)
-        _instance_ = new CollisionHandler();
-    return _instance_;
-}
-
 void CollisionHandler::collide(Body* body0, Body* body1, phys_t impulse) {
     std::map<Body*, Character*>::iterator it;
     phys_t dmg = 0.001 * impulse * impulse * (body0->getInvMass() +
@@ -51,3 +44,6 @@ void CollisionHandler::monitor(Body* body, Character* character) {
     monitored_.insert(std::pair<Body*, Character*>(body, character));
 }
 
+void CollisionHandler::unmonitor(Body* body) {
+    monitored_.erase(body);
+}
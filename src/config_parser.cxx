@@ -24,9 +24,10 @@
 
 using namespace std;
 
-void ConfigParser::readBindings(Player* player, const char* file) {
+void ConfigParser::readBindings(InputRouter* router, Player* player,
+        const char* file) {
     string tmp;
-    int code;
+    int code, pad;
     ifstream in;
     in.open(file);
     if (in.fail()) {
@@ -40,15 +41,19 @@ void ConfigParser::readBindings(Player* player, const char* file) {
                 in >> tmp;
                 in >> tmp;
                 in >> code;
-                player->bindKey((SDLKey) code, (ActionType) i);
+                router->bind(InputRouter::KEY, 0, code, player,
+                        (ActionType) i);
             }
         }
-        if (tmp == "[gamepad]") {
+        pad = 1;
+        if (tmp == "[gamepad]" ||
+                sscanf(tmp.c_str(), "[gamepad %d]", &pad) == 1) {
             for (int i = 1; i < NUM_ACTIONTYPE; ++i) {
                 in >> tmp;
                 in >> tmp;
                 in >> code;
-                player->bindJoyButton((Uint8) code, (ActionType) i);
+                router->bind(InputRouter::JOY_BUTTON, pad - 1, code, player,
+                        (ActionType) i);
             }
         }
     }
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include "debris_manager.hxx"
+
+DebrisManager::DebrisManager(GameUniverse* universe, phys_t lifetime,
+        int budget, phys_t fadeTime) :
+        universe_(universe),
+        knownBodies_(),
+        knownFades_(),
+        lifetime_(lifetime),
+        fadeTime_(min(fadeTime, lifetime)),
+        budget_(budget),
+        numSolid_(0),
+        focusRadius_(0),
+        debris_() {
+    focus_(0, 0);
+}
+
+void DebrisManager::add(SmallBody* body, Handle handle, float* fade) {
+    Debris d = { body, handle, fade, 0, lifetime_ };
+    debris_.push_back(d);
+    std::vector<SmallBody*>::iterator i = std::find(knownBodies_.begin(),
+            knownBodies_.end(), body);
+    if (i == knownBodies_.end()) {
+        knownBodies_.push_back(body);
+        knownFades_.push_back(fade);
+    }
+    else
+        knownFades_[i - knownBodies_.begin()] = fade;
+    *fade = 1;
+    ++numSolid_;
+}
+
+void DebrisManager::release(SmallBody* body) {
+    for (int i = 0; i < (int) debris_.size(); ++i) {
+        if (debris_[i].body == body) {
+            if (debris_[i].life - debris_[i].age > fadeTime_)
+                --numSolid_;
+            debris_[i] = debris_.back();
+            debris_.pop_back();
+            return;
+        }
+    }
+}
+
+void DebrisManager::removeLink(Handle handle) {
+    universe_->removeLink(handle);
+}
+
+void DebrisManager::setFocus(vector2p centre, phys_t radius) {
+    focus_ = centre;
+    focusRadius_ = radius;
+}
+
+int DebrisManager::getNumDebris() {
+    return debris_.size();
+}
+
+void DebrisManager::update(phys_t dt) {
+    while (numSolid_ > budget_ && expire())
+        ;
+    for (int i = 0; i < (int) debris_.size(); ++i) {
+        Debris& d = debris_[i];
+        bool solid = d.life - d.age > fadeTime_;
+        d.age += dt;
+        phys_t left = d.life - d.age;
+        if (solid && left <= fadeTime_)
+            --numSolid_;
+        if (left <= 0) {
+            remove(i--);
+            continue;
+        }
+        *d.fade = left < fadeTime_ ? left / fadeTime_ : 1;
+    }
+}
+
+bool DebrisManager::expire() {
+    // Debris away from the living goes first, farthest first. Failing that,
+    // the oldest goes.
+    int victim = -1;
+    phys_t far = 0, old = -1;
+    for (int i = 0; i < (int) debris_.size(); ++i) {
+        const Debris& d = debris_[i];
+        if (d.life - d.age <= fadeTime_)
+            continue;
+        phys_t out = (d.body->getPosition() - focus_).length() -
+                focusRadius_;
+        if (out > far) {
+            victim = i;
+            far = out;
+        }
+        else if (far == 0 && d.age > old) {
+            victim = i;
+            old = d.age;
+        }
+    }
+    if (victim < 0)
+        return false;
+    debris_[victim].life = debris_[victim].age + fadeTime_;
+    --numSolid_;
+    return true;
+}
+
+void DebrisManager::remove(int i) {
+    universe_->removeBody(debris_[i].handle);
+    *debris_[i].fade = 0;
+    debris_[i] = debris_.back();
+    debris_.pop_back();
+}
+
+void DebrisManager::save(Snapshot& s) {
+    int n = debris_.size();
+    s.write(n);
+    for (int i = 0; i < n; ++i) {
+        const Debris& d = debris_[i];
+        s.writeIndex(d.body, knownBodies_);
+        s.write(d.handle);
+        s.write(d.age);
+        s.write(d.life);
+    }
+    s.write(numSolid_);
+    s.write(focus_);
+    s.write(focusRadius_);
+}
+
+void DebrisManager::restore(Snapshot& s) {
+    int n = -1;
+    s.read(n);
+    if (n < 0 || !s.isGood())
+        return;
+    debris_.resize(n);
+    for (int i = 0; i < n && s.isGood(); ++i) {
+        Debris& d = debris_[i];
+        s.readIndex(d.body, knownBodies_);
+        int k = std::find(knownBodies_.begin(), knownBodies_.end(), d.body) -
+                knownBodies_.begin();
+        d.fade = k < (int) knownFades_.size() ? knownFades_[k] : NULL;
+        s.read(d.handle);
+        s.read(d.age);
+        s.read(d.life);
+    }
+    s.read(numSolid_);
+    s.read(focus_);
+    s.read(focusRadius_);
+}
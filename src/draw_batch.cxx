@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game_graphics_gl.hxx"
+
+DrawBatch::DrawBatch() :
+        vertices_(),
+        texCoords_(),
+        colours_(),
+        texture_(0),
+        premul_(false) {
+}
+
+void DrawBatch::setTexture(GLuint texture, bool premul) {
+    if (texture == texture_ && premul == premul_)
+        return;
+    flush();
+    texture_ = texture;
+    premul_ = premul;
+}
+
+void DrawBatch::addRectangle(const DrawState& state, const GLfloat* colour,
+        GLfloat w, GLfloat h, GLfloat dx, GLfloat dy) {
+    // Two triangles, with the texture the right way up.
+    addVertex(state, colour, dx - w, dy - h, 0.0, 1.0);
+    addVertex(state, colour, dx + w, dy - h, 1.0, 1.0);
+    addVertex(state, colour, dx + w, dy + h, 1.0, 0.0);
+    addVertex(state, colour, dx - w, dy - h, 0.0, 1.0);
+    addVertex(state, colour, dx + w, dy + h, 1.0, 0.0);
+    addVertex(state, colour, dx - w, dy + h, 0.0, 0.0);
+}
+
+void DrawBatch::addTriangles(const DrawState& state, const GLfloat* colour,
+        const GLfloat* points, int n) {
+    for (int i = 0; i < n * 3; ++i)
+        addVertex(state, colour, points[i * 2], points[i * 2 + 1], 0.0, 0.0);
+}
+
+void DrawBatch::flush() {
+    if (vertices_.empty())
+        return;
+    Screen::getInstance()->setDrawingMode(premul_ ? -1 : 0,
+            Screen::_DM_PREMUL);
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, &vertices_[0]);
+    glTexCoordPointer(2, GL_FLOAT, 0, &texCoords_[0]);
+    glColorPointer(4, GL_FLOAT, 0, &colours_[0]);
+    glDrawArrays(GL_TRIANGLES, 0, vertices_.size() / 2);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    // Keep the memory for the next run.
+    vertices_.clear();
+    texCoords_.clear();
+    colours_.clear();
+}
+
+void DrawBatch::addVertex(const DrawState& state, const GLfloat* colour,
+        GLfloat x, GLfloat y, GLfloat u, GLfloat v) {
+    GLfloat p[2];
+    state.map(x, y, p);
+    vertices_.insert(vertices_.end(), p, p + 2);
+    texCoords_.push_back(u);
+    texCoords_.push_back(v);
+    if (!premul_) {
+        colours_.insert(colours_.end(), colour, colour + 4);
+        return;
+    }
+    // Premultiplied runs blend with the colour scaled by its opacity.
+    for (int i = 0; i < 3; ++i)
+        colours_.push_back(colour[i] * colour[3]);
+    colours_.push_back(colour[3]);
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "event_queue.hxx"
+#include "template_math.hxx"
+
+EventQueue::EventQueue() :
+        events_(),
+        numDue_(0),
+        frameTime_(SDL_GetTicks()) {
+}
+
+void EventQueue::poll() {
+    StampedEvent e;
+    e.time = SDL_GetTicks();
+    e.step = 0;
+    while (SDL_PollEvent(&e.event))
+        events_.push_back(e);
+}
+
+void EventQueue::wait(Uint32 ms) {
+    Uint32 start = SDL_GetTicks();
+    poll();
+    while (SDL_GetTicks() - start < ms) {
+        SDL_Delay(1);
+        poll();
+    }
+}
+
+void EventQueue::block() {
+    // Events may already have come in while waiting out the frame.
+    poll();
+    if (events_.size() > numDue_)
+        return;
+    StampedEvent e;
+    e.step = 0;
+    if (!SDL_WaitEvent(&e.event))
+        return;
+    e.time = SDL_GetTicks();
+    events_.push_back(e);
+    poll();
+}
+
+int EventQueue::startFrame(int steps) {
+    poll();
+    Uint32 now = SDL_GetTicks(), span = now - frameTime_;
+    for (std::deque<StampedEvent>::iterator i = events_.begin() + numDue_;
+            i != events_.end(); ++i) {
+        // Events from before the last frame are left over; apply them first.
+        Uint32 t = i->time - frameTime_;
+        t = t > span ? 0 : t;
+        i->step = span ? min<int>(t * steps / span, max(steps - 1, 0)) : 0;
+    }
+    numDue_ = events_.size();
+    frameTime_ = now;
+    return numDue_;
+}
+
+bool EventQueue::next(int step, SDL_Event& event) {
+    if (!numDue_ || events_.front().step > step)
+        return false;
+    event = events_.front().event;
+    events_.pop_front();
+    --numDue_;
+    return true;
+}
@@ -24,10 +24,9 @@
 
 #include <SDL/SDL.h>
 #include "game.hxx"
-#include "get_font.hxx"
-#include "get_texture.hxx"
 #include "menu.hxx"
 #include "config_parser.hxx"
+#include "planner.hxx"
 
 const int Game::_MAX_PC = 16;
 const int Game::_MAX_PLAN = 1;
@@ -36,67 +35,55 @@ const phys_t Game::_GM = 628;
 const phys_t Game::_R = 9.0;
 const phys_t Game::_S = sqrt<phys_t> (_GM / _R) * 0.5;
 const phys_t Game::_PR = 7.0;
+const phys_t Game::_PH = 0.6;
+const phys_t Game::_DEBRIS_LIFE = 20.0;
+const phys_t Game::_DEBRIS_FADE = 2.0;
+const int Game::_DEBRIS_BUDGET = 60;
 
 bool Game::handle(const SDL_Event& event) {
     // Input
-    for (std::vector<Player*>::const_iterator i = players_.begin();
-            i != players_.end(); ++i)
-        (*i)->handle(event);
-    return true;
+    return router_.handle(event);
 }
 
 Game::Game(Screen* screen, int numPlayers, int numCPUs) :
-        screen_(screen),
+        numPlayers_(numPlayers),
+        numCPUs_(numCPUs),
         planets_(),
         backgroundModifier_(NULL),
         camera_(NULL),
+        controller_(NULL),
+        debris_(NULL),
         characters_(),
         characterGraphics_(),
         planetColour_(NULL),
         universe_(NULL),
         tex_(0),
-        numPlayers_(numPlayers),
-        numCPUs_(numCPUs),
+        textures_(NULL),
+        colours_(0),
         planetFixture_(NULL),
-        massIndicatorLabels_(),
-        planetCircle_(NULL),
-        players_(),
-        massIndicatorPosMods_(),
-        scene_(NULL),
-        foreground_(NULL),
-        backgroundSprite_(NULL),
-        planetDisk_(NULL),
         matCharBody_(NULL),
         matCharHead_(NULL),
         matCharLimbs_(NULL),
         matCharLimbsOff_(NULL),
         matPlanet_(NULL),
+        massIndicatorLabels_(),
         massIndicators_(),
-        massIndicatorGfx_() {
-    tex_ = getTexture(PACKAGE_GFX_DIR "background.png");
+        massIndicatorGfx_(),
+        planetTerrain_(NULL),
+        players_(),
+        generation_(0),
+        router_(),
+        cpus_(),
+        planner_(NULL),
+        captured_(),
+        inputs_(),
+        massIndicatorPosMods_(),
+        screen_(screen),
+        scene_(NULL),
+        foreground_(NULL),
+        backgroundSprite_(NULL),
+        planetGraphic_(NULL) {
     conceive();
-    for (std::vector<Character*>::const_iterator i = characters_.begin();
-            i != characters_.end(); ++i)
-        (*i)->addToUniverse(universe_);
-    planetDisk_->addModifier(planetFixture_);
-    planetDisk_->getDisk()->addModifier(planetColour_);
-    // Bad hard coding incoming. The game is hard coded for three players.
-    switch (numPlayers_) {
-    default:
-        if (numPlayers_ < 1)
-            break;
-        ;
-    case 3:
-        ConfigParser::readBindings(players_[2],
-                PACKAGE_CFG_DIR "controllers3.conf");
-    case 2:
-        ConfigParser::readBindings(players_[1],
-                PACKAGE_CFG_DIR "controllers2.conf");
-    case 1:
-        ConfigParser::readBindings(players_[0],
-                PACKAGE_CFG_DIR "controllers1.conf");
-    }
-    // TODO: When the game is abstracted for more players, fix ^
 #if VERBOSE
     printf("controllers player 1:\n"
             "\t left:       \t\t        left arrow\n"
@@ -129,114 +116,267 @@ Game::Game(Screen* screen, int numPlayers, int numCPUs) :
     printf("press escape to bring up the menu again.\n"
             "press escape again to close it.\n\n\n\n");
 #endif
-    backgroundSprite_->addModifier(backgroundModifier_);
-    scene_->addGraphic(backgroundSprite_);
-    foreground_->addGraphic(planetDisk_);
-    for (std::vector<CharacterGraphic*>::const_iterator i =
-            characterGraphics_.begin(); i != characterGraphics_.end(); ++i)
-        foreground_->addGraphic(*i);
-    foreground_->addModifier(camera_);
-    scene_->addGraphic(foreground_);
-    for (std::vector<MassIndicatorGraphic*>::const_iterator i =
-            massIndicatorGfx_.begin();
-            i != massIndicatorGfx_.end(); ++i)
-        scene_->addGraphic(*i);
+    // Characters, the players' first.
+    numCPUs_ = max(numCPUs_, 0);
+    int n = numPlayers_ + numCPUs_;
+    phys_t angle = 2 * PI / n;
+    for (int i = 0; i < n; ++i) {
+        addCharacter(i * angle);
+        if (i < numPlayers_)
+            bindPlayer(i);
+    }
+    layoutMassIndicators();
+    if (!numCPUs_)
+        return;
+    // The planner replays every step, so the players' input is taken at
+    // the start of each step rather than as it comes in.
+    planner_ = new Planner(n, numPlayers_);
+    captured_.resize(n);
+    inputs_.resize(n);
+    for (int i = 0; i < numPlayers_; ++i)
+        players_[i]->setCapture(&captured_[i]);
+    for (int i = numPlayers_; i < n; ++i)
+        cpus_.push_back(new CpuPlayer(characters_[i], planner_, i));
 }
 
 Game::~Game() {
+    // Stop planning before anything the planner reads goes away.
+    delete planner_;
+    for (std::vector<CpuPlayer*>::const_iterator i = cpus_.begin();
+            i != cpus_.end(); ++i)
+        delete (*i);
     for (std::vector<Character*>::const_iterator i = characters_.begin();
             i != characters_.end(); ++i)
         delete (*i);
     for (std::vector<Player*>::const_iterator i = players_.begin();
             i != players_.end(); ++i)
         delete (*i);
-    for (std::vector<CharacterGraphic*>::const_iterator i =
-            characterGraphics_.begin(); i != characterGraphics_.end(); ++i)
-        delete (*i);
-    for (std::vector<Label*>::const_iterator i = massIndicatorLabels_.begin();
-            i != massIndicatorLabels_.end(); ++i)
-        delete (*i);
-    for (std::vector<MassIndicator*>::const_iterator i =
-            massIndicators_.begin(); i != massIndicators_.end(); ++i)
-        delete (*i);
-    for (std::vector<MassIndicatorGraphic*>::const_iterator i =
-            massIndicatorGfx_.begin(); i != massIndicatorGfx_.end(); ++i)
-        delete (*i);
-    for (std::vector<PositionModifier*>::iterator i =
-            massIndicatorPosMods_.begin(); i != massIndicatorPosMods_.end();
-            ++i)
-        delete (*i);
-    delete planetCircle_;
+    deleteGraphics();
+    delete planetTerrain_;
+    delete matCharBody_;
+    delete matCharHead_;
+    delete matCharLimbs_;
+    delete matCharLimbsOff_;
+    delete matPlanet_;
     for (std::vector<AstroBody*>::const_iterator i = planets_.begin();
             i != planets_.end(); ++i)
         delete (*i);
+    delete debris_;
     delete universe_;
-    delete backgroundSprite_;
-    delete foreground_;
-    delete planetColour_;
-    delete planetDisk_;
-    delete planetFixture_;
-    delete scene_;
+    delete controller_;
     delete camera_;
-    delete backgroundModifier_;
 }
 
 void Game::conceive() {
-    // Characters
-    phys_t angle = 2 * PI / numPlayers_;
-    vector2p pos = { _R, 0 }, vel = { 0, _S }, a = vector2p::fromAngle(angle);
     matCharBody_ = new Material(100.0, 0.5);
     matCharHead_ = new Material(10000.0, 0.1);
     matCharLimbs_ = new Material(50000.0, 1.5);
     matCharLimbsOff_ = new Material(500.0, 1.5);
-    char font[256];
-    getFont(font, sizeof(font));
-    for (int i = 0; i < numPlayers_; ++i) {
-        characters_.push_back(new Character(state2p()(pos, vel), i * angle,
-                matCharBody_, matCharHead_, matCharLimbs_, matCharLimbsOff_));
-        players_.push_back(new Player(characters_[i]));
-        characterGraphics_.push_back(new CharacterGraphic(characters_[i]));
-        char mass [4];
-        snprintf(mass, sizeof(mass), "%.0f", characters_[i]->getMass());
-        massIndicatorLabels_.push_back(new Label(font, mass, 74, .05,
-                    .02));
-        massIndicators_.push_back(new MassIndicator(i));
-        massIndicatorGfx_.push_back(new MassIndicatorGraphic(0.05f, 0.02f,
-                    massIndicators_[i], massIndicatorLabels_[i]));
-        massIndicatorPosMods_.push_back(new PositionModifier(i + 1,
-                    numPlayers_, true, -0.9));
-        massIndicatorGfx_[i]->addModifier(massIndicatorPosMods_[i]);
-        massIndicatorGfx_[i]->addModifier(
-                characterGraphics_[i]->getColourModifier());
-        pos.rotate(a);
-        vel.rotate(a);
-    }
+    controller_ = new CharacterController();
     // Planets
-    planetCircle_ = new Circle<phys_t> (_PR);
+    planetTerrain_ = new Terrain<phys_t> (_PR, _PH, 512, 1);
     matPlanet_ = new Material(100.0, 50);
-    planets_.push_back(new AstroBody(_GM, 2 * _GM * _PR * _PR / 5, -0.05, 
-                planetCircle_, matPlanet_));
-    universe_ = new GameUniverse(planets_[0]);
-    // Graphics
-    backgroundSprite_ = new Sprite(tex_, 1, 1);
-    foreground_ = new StackGraphic();
-    planetColour_ = new ColorModifier(_COL_PLANET);
-    planetDisk_ = new TestDisk(_PR, 64);
-    planetFixture_ = new GraphicFixture(planets_[0]);
-    scene_ = new StackGraphic();
-    // Camera
-    camera_ = new Camera(characters_[0]->getState(), 0.5, 0.0);
-    backgroundModifier_ = new BackgroundModifier(camera_);
+    planets_.push_back(new AstroBody(vector2p()(0, 0), _GM,
+                2 * _GM * _PR * _PR / 5, -0.05, planetTerrain_, matPlanet_));
+    universe_ = new GameUniverse();
+    for (std::vector<AstroBody*>::const_iterator i = planets_.begin();
+            i != planets_.end(); ++i)
+        universe_->addPlanet(*i);
+    for (int m = 0; m < NUM_MATERIAL; ++m)
+        universe_->addMaterial(getMaterial((MaterialType) m));
+    // Room for every character, so that joining mid-game does not allocate.
+    universe_->reserve(_MAX_PC * 6, _MAX_PC * 5);
+    debris_ = new DebrisManager(universe_, _DEBRIS_LIFE, _DEBRIS_BUDGET,
+            _DEBRIS_FADE);
+    characters_.reserve(_MAX_PC);
+    players_.reserve(_MAX_PC);
+    characterGraphics_.reserve(_MAX_PC);
+    massIndicatorLabels_.reserve(_MAX_PC);
+    massIndicators_.reserve(_MAX_PC);
+    massIndicatorGfx_.reserve(_MAX_PC);
+    massIndicatorPosMods_.reserve(_MAX_PC);
+    // Camera, starting where the first character spawns.
+    camera_ = new Camera(state2p()(_R, 0, 0, _S), 0.5, 0.0);
+    // Graphics, unless headless.
+    if (screen_)
+        conceiveGraphics();
 }
 
-void Game::update(phys_t dt) {
-    universe_->update(dt);
+void Game::addCharacter(phys_t angle) {
+    vector2p a = vector2p::fromAngle(angle);
+    vector2p pos = vector2p()(_R, 0).rotated(a),
+            vel = vector2p()(0, _S).rotated(a);
+    int i = characters_.size();
+    characters_.push_back(new Character(state2p()(pos, vel), angle,
+            matCharBody_, matCharHead_, matCharLimbs_, matCharLimbsOff_,
+            controller_));
+    characters_[i]->addToUniverse(universe_);
+    characters_[i]->setDebrisManager(debris_);
+    players_.push_back(new Player(characters_[i]));
+    ++generation_;
+    if (screen_)
+        addGraphics(i);
+}
+
+void Game::bindPlayer(int i) {
+    // The game ships with controls for three players.
+    if (i >= 3)
+        return;
+    char file[256];
+    snprintf(file, sizeof(file), PACKAGE_CFG_DIR "controllers%d.conf", i + 1);
+    ConfigParser::readBindings(&router_, players_[i], file);
+}
+
+int Game::addPlayer() {
+    int i = characters_.size();
+    if (i >= _MAX_PC || planner_)
+        return -1;
+    // Spawn opposite the mean direction of the others.
+    vector2p planetPos = planets_[0]->getPosition(), away = { 0, 0 };
     for (std::vector<Character*>::const_iterator it = characters_.begin();
             it != characters_.end(); ++it)
-        (*it)->update(dt);
-    for (std::vector<CharacterGraphic*>::const_iterator it =
-            characterGraphics_.begin(); it != characterGraphics_.end(); ++it)
-        (*it)->update();
+        away -= ((*it)->getState().p - planetPos).unit();
+    addCharacter(away.squared() > 0 ? away.angle() : 0);
+    bindPlayer(i);
+    layoutMassIndicators();
+    numPlayers_ = characters_.size();
+    return i;
+}
+
+void Game::removePlayer(int i) {
+    if (i < 0 || i >= (int) characters_.size() || planner_)
+        return;
+    characters_[i]->removeFromUniverse(universe_);
+    router_.unbind(players_[i]);
+    delete players_[i];
+    delete characters_[i];
+    players_.erase(players_.begin() + i);
+    characters_.erase(characters_.begin() + i);
+    ++generation_;
+    if (screen_)
+        removeGraphics(i);
+    layoutMassIndicators();
+    numPlayers_ = characters_.size();
+}
+
+int Game::getNumPlayers() {
+    return players_.size();
+}
+
+Player* Game::getPlayer(int i) {
+    return players_[i];
+}
+
+Character* Game::getCharacter(int i) {
+    return characters_[i];
+}
+
+int Game::getNumPlanets() {
+    return planets_.size();
+}
+
+AstroBody* Game::getPlanet(int i) {
+    return planets_[i];
+}
+
+GameUniverse* Game::getUniverse() {
+    return universe_;
+}
+
+InputRouter* Game::getInputRouter() {
+    return &router_;
+}
+
+Material* Game::getMaterial(MaterialType m) {
+    Material* materials[] = { matCharBody_, matCharHead_, matCharLimbs_,
+            matCharLimbsOff_, matPlanet_ };
+    return materials[m];
+}
+
+void Game::setLocalPlayer(int i) {
+    router_.clear();
+    ConfigParser::readBindings(&router_, players_[i],
+            PACKAGE_CFG_DIR "controllers1.conf");
+}
+
+void Game::setNumPlayers(int n) {
+    // The planner replays a fixed cast, so the count waits for a new game.
+    if (planner_)
+        return;
+    n = min(max(n, 1), _MAX_PC);
+    while ((int) players_.size() < n && addPlayer() >= 0) ;
+    while ((int) players_.size() > n)
+        removePlayer(players_.size() - 1);
+}
+
+void Game::save(Snapshot& s) {
+    s.clear();
+    s.write(generation_);
+    universe_->save(s);
+    controller_->save(s);
+    for (std::vector<Character*>::const_iterator i = characters_.begin();
+            i != characters_.end(); ++i)
+        (*i)->save(s);
+    debris_->save(s);
+    camera_->save(s);
+}
+
+bool Game::restore(Snapshot& s, bool camera) {
+    int generation = -1;
+    if (!s.rewind())
+        return false;
+    s.read(generation);
+    if (generation != generation_)
+        return false;
+    universe_->restore(s);
+    controller_->restore(s);
+    for (std::vector<Character*>::const_iterator i = characters_.begin();
+            i != characters_.end(); ++i)
+        (*i)->restore(s);
+    debris_->restore(s);
+    if (camera)
+        camera_->restore(s);
+    return s.isGood();
+}
+
+void Game::getFrame(StateFrame& f) {
+    f.resize(characters_.size());
+    f.setPlanetAngle(StateFrame::toAngle(planets_[0]->getRotor()));
+    for (int i = 0; i < (int) characters_.size(); ++i)
+        characters_[i]->getFrame(f.getCharacter(i));
+}
+
+void Game::setFrame(const StateFrame& f) {
+    setNumPlayers(f.getNumCharacters());
+    planets_[0]->setPose(planets_[0]->getPosition(),
+            StateFrame::fromAngle(f.getPlanetAngle()));
+    int n = min((int) characters_.size(), f.getNumCharacters());
+    for (int i = 0; i < n; ++i)
+        characters_[i]->setFrame(f.getCharacter(i));
+}
+
+void Game::update(phys_t dt) {
+    step(dt);
+    updateGraphics();
+}
+
+void Game::applyInputs(phys_t dt) {
+    for (int i = 0; i < numPlayers_; ++i) {
+        captured_[i].apply(players_[i], inputs_[i]);
+        inputs_[i] = captured_[i];
+    }
+    for (int i = numPlayers_; i < (int) characters_.size(); ++i)
+        inputs_[i] = cpus_[i - numPlayers_]->update();
+    planner_->record(&inputs_[0], dt);
+}
+
+void Game::step(phys_t dt) {
+    if (planner_)
+        applyInputs(dt);
+    controller_->update(dt);
+    universe_->update(dt);
+    updateFocus();
+    debris_->update(dt);
 }
 
 void Game::updateCamera(GLfloat dt) {
@@ -284,13 +424,28 @@ void Game::updateCamera(GLfloat dt) {
     camera_->update(dt);
 }
 
-void Game::draw() {
-    scene_->draw();
-    int i = 0;
-    char mass [4];
+void Game::updateFocus() {
+    // Keep the debris near the living, whatever the camera is doing, so
+    // that every copy of the game retires the same debris.
+    vector2p centre = vector2p()(0, 0);
+    int n = 0;
+    for (std::vector<Character*>::const_iterator it = characters_.begin();
+            it != characters_.end(); ++it) {
+        if ((*it)->isDead())
+            continue;
+        centre += (*it)->getState().p;
+        ++n;
+    }
+    if (n == 0)
+        return;
+    centre /= n;
+    phys_t radius = 0.0;
     for (std::vector<Character*>::const_iterator it = characters_.begin();
-            it != characters_.end(); ++it, ++i) {
-        snprintf(mass, sizeof(mass), "%.0f", (*it)->getMass());
-        massIndicatorLabels_[i]->setText(mass);
+            it != characters_.end(); ++it) {
+        if ((*it)->isDead())
+            continue;
+        radius = max(radius, (centre - (*it)->getState().p).squared());
     }
+    debris_->setFocus(centre, sqrt(radius) + 2);
 }
+
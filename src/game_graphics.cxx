@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2011, 2012, 2013 Alexander Berntsen <alexander@plaimi.net>
+ * Copyright (C) 2011, 2012 Stian Ellingsen <stian@plaimi.net>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The graphics of a game, made only when it has a screen. The headless
+ * server links game_headless.cxx instead.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "game.hxx"
+#include "get_font.hxx"
+
+void Game::conceiveGraphics() {
+    textures_ = new TextureLoader();
+    tex_ = textures_->getTexture(PACKAGE_GFX_DIR "background.png");
+    getFont(font_, sizeof(font_));
+    backgroundSprite_ = new Sprite(tex_, 1, 1);
+    foreground_ = new StackGraphic();
+    planetColour_ = new ColorModifier(_COL_PLANET);
+    planetGraphic_ = new TerrainGraphic(planetTerrain_);
+    planetFixture_ = new GraphicFixture(planets_[0]);
+    scene_ = new StackGraphic();
+    backgroundModifier_ = new BackgroundModifier(camera_);
+    planetGraphic_->addModifier(planetFixture_);
+    planetGraphic_->addModifier(planetColour_);
+    backgroundSprite_->addModifier(backgroundModifier_);
+    scene_->addGraphic(backgroundSprite_);
+    foreground_->addGraphic(planetGraphic_);
+    foreground_->addModifier(camera_);
+    scene_->addGraphic(foreground_);
+}
+
+void Game::addGraphics(int i) {
+    characterGraphics_.push_back(new CharacterGraphic(characters_[i],
+            textures_, colours_++));
+    foreground_->addGraphic(characterGraphics_[i]);
+    char mass [4];
+    snprintf(mass, sizeof(mass), "%.0f", characters_[i]->getMass());
+    massIndicatorLabels_.push_back(new Label(font_, mass, 74, .05, .02));
+    massIndicators_.push_back(new MassIndicator(i));
+    massIndicatorGfx_.push_back(new MassIndicatorGraphic(0.05f, 0.02f,
+                massIndicators_[i], massIndicatorLabels_[i]));
+    massIndicatorPosMods_.push_back(new PositionModifier(i + 1, i + 1, true,
+                -0.9));
+    massIndicatorGfx_[i]->addModifier(massIndicatorPosMods_[i]);
+    massIndicatorGfx_[i]->addModifier(
+            characterGraphics_[i]->getColourModifier());
+    scene_->addGraphic(massIndicatorGfx_[i]);
+}
+
+void Game::removeGraphics(int i) {
+    foreground_->removeGraphic(characterGraphics_[i]);
+    scene_->removeGraphic(massIndicatorGfx_[i]);
+    delete characterGraphics_[i];
+    delete massIndicatorGfx_[i];
+    delete massIndicatorLabels_[i];
+    delete massIndicators_[i];
+    delete massIndicatorPosMods_[i];
+    characterGraphics_.erase(characterGraphics_.begin() + i);
+    massIndicatorGfx_.erase(massIndicatorGfx_.begin() + i);
+    massIndicatorLabels_.erase(massIndicatorLabels_.begin() + i);
+    massIndicators_.erase(massIndicators_.begin() + i);
+    massIndicatorPosMods_.erase(massIndicatorPosMods_.begin() + i);
+}
+
+void Game::deleteGraphics() {
+    for (std::vector<CharacterGraphic*>::const_iterator i =
+            characterGraphics_.begin(); i != characterGraphics_.end(); ++i)
+        delete (*i);
+    for (std::vector<Label*>::const_iterator i = massIndicatorLabels_.begin();
+            i != massIndicatorLabels_.end(); ++i)
+        delete (*i);
+    for (std::vector<MassIndicator*>::const_iterator i =
+            massIndicators_.begin(); i != massIndicators_.end(); ++i)
+        delete (*i);
+    for (std::vector<MassIndicatorGraphic*>::const_iterator i =
+            massIndicatorGfx_.begin(); i != massIndicatorGfx_.end(); ++i)
+        delete (*i);
+    for (std::vector<PositionModifier*>::iterator i =
+            massIndicatorPosMods_.begin(); i != massIndicatorPosMods_.end();
+            ++i)
+        delete (*i);
+    delete backgroundSprite_;
+    delete foreground_;
+    delete planetColour_;
+    delete planetGraphic_;
+    delete planetFixture_;
+    delete scene_;
+    delete backgroundModifier_;
+    delete textures_;
+}
+
+void Game::layoutMassIndicators() {
+    int n = massIndicators_.size();
+    for (int i = 0; i < n; ++i) {
+        massIndicators_[i]->setPosition(i);
+        massIndicatorPosMods_[i]->setPosition(i + 1, n);
+    }
+}
+
+void Game::updateGraphics() {
+    for (std::vector<CharacterGraphic*>::const_iterator it =
+            characterGraphics_.begin(); it != characterGraphics_.end(); ++it)
+        (*it)->update();
+}
+
+void Game::draw() {
+    if (!screen_)
+        return;
+    scene_->draw();
+    int i = 0;
+    char mass [4];
+    for (std::vector<Character*>::const_iterator it = characters_.begin();
+            it != characters_.end(); ++it, ++i) {
+        snprintf(mass, sizeof(mass), "%.0f", (*it)->getMass());
+        massIndicatorLabels_[i]->setText(mass);
+    }
+}
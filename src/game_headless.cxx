@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The graphics of a game that never has a screen, for the headless
+ * server. Linking this instead of game_graphics.cxx leaves out the
+ * graphics, and the libraries they need.
+ */
+
+#include "game.hxx"
+
+void Game::conceiveGraphics() {
+}
+
+void Game::addGraphics(int) {
+}
+
+void Game::removeGraphics(int) {
+}
+
+void Game::deleteGraphics() {
+}
+
+void Game::layoutMassIndicators() {
+}
+
+void Game::updateGraphics() {
+}
+
+void Game::draw() {
+}
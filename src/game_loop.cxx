@@ -19,28 +19,31 @@
  */
 
 #include <GL/gl.h>
-#include "repeat.hxx"
 #include "get_font.hxx"
 #include "game_loop.hxx"
 #include "event_code.hxx"
 #include "step_timer.hxx"
 
 GameLoop::GameLoop() :
-        screen_(Screen::getInstance()),
-        prevWidth_(0),
-        prevHeight_(0),
-        limbsOff_(NULL),
+        numPlayers_(1),
+        numCPUs_(0),
         running_(true),
         menuP_(true),
         inputP_(false),
         userInput_(),
-        numPlayers_(1),
-        numCPUs_(0),
         activeInput_(NUM_EVENT_CODE),
-        keystate_(SDL_GetKeyState(NULL)),
-        stepCounter_(0),
+        screen_(Screen::getInstance()),
+        limbsOff_(NULL),
+        networked_(false),
+        net_(),
+        session_(NULL),
+        client_(NULL),
+        stream_(NULL),
+        inputFieldGraphic_(NULL),
         menu_(),
-        inputFieldGraphic_(NULL) {
+        prevWidth_(0),
+        prevHeight_(0),
+        events_() {
     // This is necessary for the input field
     SDL_EnableUNICODE(1);
     // Stores user input from the input field in menu
@@ -49,84 +52,143 @@ GameLoop::GameLoop() :
 }
 
 GameLoop::~GameLoop() {
+    delete session_;
+    delete client_;
+    delete stream_;
     free(userInput_);
 }
 
-bool GameLoop::handleEvents() {
-    SDL_Event event;
-    stepCounter_ = 0;
-    // Events
-    while (SDL_PollEvent(&event)) {
-        //Quit
-        if (event.type == SDL_QUIT)
-                running_ = false;
-        // Screen
-        if (keystate_[SDLK_LALT] && event.type == SDL_KEYDOWN && 
-                event.key.keysym.sym == SDLK_RETURN) {
-            // Enter/leave fullscreen
-            if (!screen_->getFullscreen()) {
-                prevWidth_ = screen_->getSurfaceWidth();
-                prevHeight_ = screen_->getSurfaceHeight();
-                screen_->setVideoMode(0, 0, 32, true);
-            } else
-                screen_->setVideoMode(prevWidth_, prevHeight_, 32, false);
+void GameLoop::setNetwork(const NetConfig& net) {
+    networked_ = true;
+    net_ = net;
+    // One player here, and one for each peer. A server has its own.
+    numPlayers_ = net_.peers.size() + (net_.loopbackLatency >= 0) + 1;
+    if (!net_.server.empty())
+        numPlayers_ = 1;
+    net_.localPlayer = min(net_.localPlayer, numPlayers_ - 1);
+}
+
+bool GameLoop::setStream(const char* path) {
+    delete stream_;
+    stream_ = new StateStream();
+    if (stream_->open(path))
+        return true;
+    delete stream_;
+    stream_ = NULL;
+    return false;
+}
+
+void GameLoop::startSession() {
+    if (!net_.server.empty()) {
+        client_ = new GameClient(limbsOff_);
+        if (!client_->connect(net_.server.c_str())) {
+            printf("ERROR: Could not connect to the server.\n");
+            delete client_;
+            client_ = NULL;
         }
-        if (screen_->handle(event))
-            continue;
-        // Menu
-        if (event.type == SDL_KEYDOWN &&
-                event.key.keysym.sym == SDLK_ESCAPE && !inputP_)
-            menuP_ = !menuP_;
-        // Input field
-        if (inputP_) {
-            if (!menu_.getChoice(event, userInput_)) {
-                // Update the logic's text
-                menu_.getInputField()->setText(userInput_);
-                // Update the graphic's text
-                inputFieldGraphic_->setText();
-            }
-            else {
-                inputP_ = false;
-                menuP_ = true;
-                switch (activeInput_) {
-                case CHANGE_PLAYERS:
-                    numPlayers_ = max(strtol(userInput_, 0, 10), 1L);
-                    break;
-                case CHANGE_CPUS:
-                    numCPUs_ = max(strtol(userInput_, 0, 10), 1L);
-                    break;
-                default:
-                    ;
-                }
-                userInput_[0] = '\0';
-            }
+        return;
+    }
+    session_ = new NetSession(limbsOff_, net_.localPlayer, net_.delay);
+    bool ok = session_->open(net_.port);
+    for (std::vector<std::string>::const_iterator i = net_.peers.begin();
+            i != net_.peers.end() && ok; ++i)
+        ok = session_->addPeer(i->c_str());
+    // The loopback peer plays the last player not played here.
+    int last = numPlayers_ - 1;
+    if (ok && net_.loopbackLatency >= 0)
+        ok = session_->addLoopbackPeer(last == net_.localPlayer ? last - 1 :
+                last, net_.loopbackLatency, net_.loopbackLoss);
+    if (!ok) {
+        printf("ERROR: Could not start the network session.\n");
+        delete session_;
+        session_ = NULL;
+    }
+}
+
+void GameLoop::handleEvent(SDL_Event& event) {
+    //Quit
+    if (event.type == SDL_QUIT)
+            running_ = false;
+    // Screen. The event may be older than the key state, so go by its
+    // modifiers.
+    if (event.type == SDL_KEYDOWN && event.key.keysym.mod & KMOD_LALT &&
+            event.key.keysym.sym == SDLK_RETURN) {
+        // Enter/leave fullscreen
+        if (!screen_->getFullscreen()) {
+            prevWidth_ = screen_->getSurfaceWidth();
+            prevHeight_ = screen_->getSurfaceHeight();
+            screen_->setVideoMode(0, 0, 32, true);
+        } else
+            screen_->setVideoMode(prevWidth_, prevHeight_, 32, false);
+    }
+    if (screen_->handle(event))
+        return;
+    // Menu
+    if (event.type == SDL_KEYDOWN &&
+            event.key.keysym.sym == SDLK_ESCAPE && !inputP_)
+        menuP_ = !menuP_;
+    // Input field
+    if (inputP_) {
+        if (!menu_.getChoice(event, userInput_)) {
+            // Update the logic's text
+            menu_.getInputField()->setText(userInput_);
+            // Update the graphic's text
+            inputFieldGraphic_->setText();
         }
-        else if (menuP_)
-            menuP_ = !menu_.handle(event);
-        // Game
-        else
-            if (limbsOff_)
-                limbsOff_->handle(event);
-        // Userevents
-        if (event.type == SDL_USEREVENT) {
-            switch (event.user.code) {
-            case NEW_GAME:
-                if (limbsOff_)
-                    delete limbsOff_;
-                limbsOff_ = new Game(screen_, numPlayers_, numCPUs_);
-                break;
+        else {
+            inputP_ = false;
+            menuP_ = true;
+            switch (activeInput_) {
             case CHANGE_PLAYERS:
-                activeInput_ = CHANGE_PLAYERS;
-                inputP_ = true;
+                // Networked games have one player for each peer.
+                if (networked_)
+                    break;
+                numPlayers_ = max(strtol(userInput_, 0, 10), 1L);
+                if (limbsOff_)
+                    limbsOff_->setNumPlayers(numPlayers_);
                 break;
             case CHANGE_CPUS:
-                activeInput_ = CHANGE_CPUS;
-                inputP_ = true;
-                inputP_ = true;
+                numCPUs_ = max(strtol(userInput_, 0, 10), 0L);
                 break;
             default:
                 ;
             }
+            userInput_[0] = '\0';
+        }
+    }
+    else if (menuP_)
+        menuP_ = !menu_.handle(event);
+    // Game
+    else
+        if (limbsOff_)
+            limbsOff_->handle(event);
+    // Userevents
+    if (event.type == SDL_USEREVENT) {
+        switch (event.user.code) {
+        case NEW_GAME:
+            delete session_;
+            delete client_;
+            session_ = NULL;
+            client_ = NULL;
+            if (limbsOff_)
+                delete limbsOff_;
+            // Only the peers or the server play networked games.
+            limbsOff_ = new Game(screen_, numPlayers_,
+                    networked_ ? 0 : numCPUs_);
+            if (networked_)
+                startSession();
+            break;
+        case CHANGE_PLAYERS:
+            activeInput_ = CHANGE_PLAYERS;
+            inputP_ = true;
+            break;
+        case CHANGE_CPUS:
+            activeInput_ = CHANGE_CPUS;
+            inputP_ = true;
+            inputP_ = true;
+            break;
+        default:
+            ;
         }
     }
 }
@@ -145,18 +207,48 @@ int GameLoop::run() {
     getFont(font, sizeof(font));
     inputFieldGraphic_ = new InputFieldGraphic(font, menu_.getInputField());
     Uint32 time = SDL_GetTicks();
+    bool drawn = false;
     while (running_) {
-        int steps = timer.getStepTime() * _STEPS_PER_SECOND;
-        timer.time(steps / _STEPS_PER_SECOND);
-        if (limbsOff_) {
-            REPEAT(steps, I) {
-                limbsOff_->update(1.0 / _STEPS_PER_SECOND);
-                if (++stepCounter_ == _EVENT_INTERVAL)
-                    handleEvents();
+        // The menu pauses games played here. Networked games go on.
+        bool paused = limbsOff_ && (menuP_ || inputP_) && !session_ &&
+                !client_;
+        // Nothing moves on a still screen, so sleep until something
+        // happens, and only draw it again if something did.
+        bool still = !limbsOff_ || paused;
+        int steps = 0;
+        if (still && drawn)
+            events_.block();
+        else if (!still) {
+            steps = timer.getStepTime() * _STEPS_PER_SECOND;
+            timer.time(steps / _STEPS_PER_SECOND);
+        }
+        // What is drawn stays up to date if nothing happened.
+        drawn = events_.startFrame(steps) == 0 && still && drawn;
+        SDL_Event event;
+        if (!still) {
+            for (int i = 0; i < steps; ++i) {
+                // Apply the events that came in during this step's time.
+                while (events_.next(i, event))
+                    handleEvent(event);
+                if (client_)
+                    client_->update();
+                else if (session_)
+                    session_->update(1.0 / _STEPS_PER_SECOND);
+                else
+                    limbsOff_->update(1.0 / _STEPS_PER_SECOND);
+                if (stream_)
+                    stream_->collect(limbsOff_);
             }
             limbsOff_->updateCamera(steps / _STEPS_PER_SECOND);
-        } else
-            handleEvents();
+            if (stream_)
+                stream_->publish(limbsOff_);
+        }
+        // Without a game, or with no steps this frame, apply them now.
+        while (events_.next(steps, event))
+            handleEvent(event);
+        if (drawn)
+            continue;
+        drawn = still;
         // Draw
         glClear(GL_COLOR_BUFFER_BIT);
         // Input field
@@ -171,11 +263,13 @@ int GameLoop::run() {
         Uint32 delta = SDL_GetTicks() - time;
         int wait = 1000 / _MAX_FPS - delta;
         if (wait > 0) {
-            SDL_Delay(wait);
+            events_.wait(wait);
             delta = SDL_GetTicks() - time;
         }
         time += delta;
-        timer.targetTime(delta / 1000.0);
+        // Time stands still on a still screen.
+        if (!still)
+            timer.targetTime(delta / 1000.0);
         // Swap buffers
         SDL_GL_SwapBuffers();
     }
@@ -19,7 +19,8 @@
  */
 
 #include <math.h>
-#include "collision_handler.hxx"
+#include <algorithm>
+#include <limits>
 #include "geometry.hxx"
 #include "game_physics.hxx"
 
@@ -28,24 +29,44 @@ SmallBody::SmallBody(state2p s, phys_t mass, phys_t orientation, phys_t av,
             int collisionGroup) :
         Body(s, mass, orientation, av, moi, shape, material),
         nextState_(getBodyState()),
-        collisionGroup_(collisionGroup) {
+        collisionGroup_(collisionGroup),
+        orbit_(),
+        primary_(NULL),
+        orbiting_(false),
+        bound_(false),
+        interacting_(false),
+        crowded_(true),
+        freeFlying_(false),
+        span_(1),
+        spanStart_(0) {
 }
 
-bool SmallBody::interact(AstroBody* b, double dt, vector2p& p, vector2p& im) {
+void SmallBody::setCollisionGroup(int group) {
+    collisionGroup_ = group;
+}
+
+bool SmallBody::probe(AstroBody* b, RayQuery& q) {
+    return false;
+}
+
+bool SmallBody::interact(AstroBody* b, const RayHit& hit, double dt,
+        vector2p& p, vector2p& im) {
     return false;
 }
 
-void SmallBody::applyImpulseAndRewind(vector2p impulse, vector2p pos, phys_t dt,
-        phys_t fraction) {
+void SmallBody::applyImpulseAndRewind(vector2p impulse, vector2p pos, phys_t h,
+        phys_t time) {
     applyImpulseAt(impulse, pos);
-    updateState(dt * (1 - fraction));
+    orbiting_ = false;
+    updateState(h * (spanStart_ + span_ - time));
     nextState_ = getBodyState();
-    updateState(-dt);
+    updateState(-h * span_);
 }
 
 void SmallBody::updateState(phys_t dt) {
     s_.p += s_.v * dt;
-    orientation_ += av_ * dt;
+    rotor_.rotate(vector2p::fromSmallAngle(av_ * dt));
+    rotor_.renorm();
 }
 
 void SmallBody::setDeltaState(int i, vector2p a) {
@@ -56,109 +77,457 @@ void SmallBody::setDeltaState(int i, vector2p a) {
 bodystate SmallBody::getNextState(phys_t dt) {
     bodystate r;
     r.l = s_ + (ds_[0] + (ds_[1] + ds_[2]) * 2.0 + ds_[3]) * (dt / 6.0);
-    r.a.p = remainder<phys_t> (orientation_ + dt * av_, 2 * PI);
-    r.a.v = av_;
+    r.r = rotor_.rotated(vector2p::fromSmallAngle(av_ * dt));
+    r.r.renorm();
+    r.av = av_;
     return r;
 }
 
-AstroBody::AstroBody(phys_t gm, phys_t moi, phys_t av, Shape<phys_t>* shape,
-        Material* material) :
-        Body(state2p()(0.0, 0.0, 0.0, 0.0), gm / G, 0.0, av, moi, shape,
-                material, true),
+bodystate SmallBody::getStateAt(int sub) {
+    phys_t f = (phys_t) (sub - spanStart_) / span_;
+    bodystate r;
+    r.l = s_ * (1 - f) + nextState_.l * f;
+    r.r = (rotor_ * (1 - f) + nextState_.r * f).unit();
+    r.av = av_;
+    return r;
+}
+
+bodystate SmallBody::getOrbitState(AstroBody* b, phys_t dt) {
+    state2p o = b->getState();
+    if (!orbiting_) {
+        orbit_.setEpoch(s_ - o, b->gm);
+        orbiting_ = true;
+    }
+    bodystate r;
+    r.l = orbit_.advance(dt) + o;
+    r.r = rotor_.rotated(vector2p::fromSmallAngle(av_ * dt));
+    r.r.renorm();
+    r.av = av_;
+    return r;
+}
+
+bool SmallBody::isFreeFlying() {
+    return !bound_ && !interacting_ && !crowded_;
+}
+
+void SmallBody::save(Snapshot& s, const std::vector<Material*>& materials,
+        const std::vector<AstroBody*>& planets) {
+    s.write(s_);
+    s.write(rotor_);
+    s.write(av_);
+    s.write(mass_);
+    s.write(invMass_);
+    s.write(moi_);
+    s.writeIndex(material_, materials);
+    s.write(ds_);
+    s.write(nextState_);
+    s.write(orbit_);
+    s.writeIndex(primary_, planets);
+    s.write(orbiting_);
+    s.write(bound_);
+    s.write(interacting_);
+    s.write(crowded_);
+    s.write(freeFlying_);
+    s.write(span_);
+    s.write(spanStart_);
+}
+
+void SmallBody::restore(Snapshot& s, const std::vector<Material*>& materials,
+        const std::vector<AstroBody*>& planets) {
+    s.read(s_);
+    s.read(rotor_);
+    s.read(av_);
+    s.read(mass_);
+    s.read(invMass_);
+    s.read(moi_);
+    s.readIndex(material_, materials);
+    s.read(ds_);
+    s.read(nextState_);
+    s.read(orbit_);
+    s.readIndex(primary_, planets);
+    s.read(orbiting_);
+    s.read(bound_);
+    s.read(interacting_);
+    s.read(crowded_);
+    s.read(freeFlying_);
+    s.read(span_);
+    s.read(spanStart_);
+}
+
+AstroBody::AstroBody(vector2p position, phys_t gm, phys_t moi, phys_t av,
+        Shape<phys_t>* shape, Material* material) :
+        Body(state2p()(position, vector2p()(0.0, 0.0)), gm / G, 0.0, av, moi,
+                shape, material, true),
         gm(gm) {
 }
 
-GameUniverse::GameUniverse(AstroBody* planet) :
-        planet_(planet),
+phys_t AstroBody::getSurfaceRadius(vector2p d) {
+    if (shape_->getType() != TERRAIN)
+        return shape_->getBoundingRadius();
+    return ((Terrain<phys_t>*) shape_)->getRadius(d.unit().unrotated(rotor_));
+}
+
+vector2p AstroBody::getSurfaceNormal(vector2p d) {
+    if (shape_->getType() != TERRAIN)
+        return d.unit();
+    return ((Terrain<phys_t>*) shape_)->getNormal(
+            d.unit().unrotated(rotor_)).rotated(rotor_);
+}
+
+bool AstroBody::castRay(vector2p o, vector2p d, phys_t& t, vector2p& n) {
+    vector2p a = o - s_.p;
+    phys_t r = shape_->getBoundingRadius(), t2;
+    if (a.squared() < r * r) {
+        r = getSurfaceRadius(a);
+        if (a.squared() <= r * r)
+            return false;
+    }
+    // Near where the ray meets it, the surface is close to a circle of its
+    // radius there, so the circle is refined towards the hit.
+    for (int i = 0;; ++i) {
+        if (!intersectLineCircle<phys_t> (a, a + d, r * r, t, t2) || t < 0)
+            return false;
+        if (shape_->getType() != TERRAIN || i == _RAY_ITERATIONS)
+            break;
+        r = getSurfaceRadius(a + d * t);
+    }
+    n = getSurfaceNormal(a + d * t);
+    return true;
+}
+
+const phys_t GameUniverse::_FREE_FLIGHT_CLEARANCE = 1.0;
+const phys_t GameUniverse::_MAX_ORBIT_PERTURBATION = 1e-4;
+const phys_t GameUniverse::_MAX_STEP_TRAVEL = 0.075;
+const phys_t GameUniverse::_MAX_STEP_PHASE = 0.5;
+
+/** Add p to the end of known, unless it is there already. */
+template<typename T>
+static void know(std::vector<T*>& known, T* p) {
+    if (std::find(known.begin(), known.end(), p) == known.end())
+        known.push_back(p);
+}
+
+/** Get the radius of the circle enclosing a body. */
+static phys_t boundingRadius(Body* b) {
+    return b->getShape()->getBoundingRadius();
+}
+
+GameUniverse::GameUniverse() :
+        planets_(),
         smallBodies_(),
-        links_() {
+        knownBodies_(),
+        knownLinks_(),
+        knownMaterials_(),
+        bodyHandles_(),
+        links_(),
+        linkAttached_(),
+        linkHandles_(),
+        springs_(),
+        gravity_(),
+        gravityChanged_(false),
+        nearPlanets_(),
+        queryX_(),
+        queryY_(),
+        queryRr_(),
+        queryT_(),
+        probes_(),
+        probeHits_(),
+        probeBodies_(),
+        collisions_(),
+        collisionHandler_(),
+        collisionGroups_(0) {
 }
 
 void GameUniverse::update(phys_t dt) {
-    planet_->orientation_ = remainder<phys_t> (
-            planet_->orientation_ + dt * planet_->av_, 2 * PI);
-    const phys_t dts[] = { 0.5 * dt, 0.5 * dt, dt };
+    const int n = 1 << _MAX_RATE_LEVEL;
+    const phys_t h = dt / n;
+    std::vector<AstroBody*>::iterator ip;
     std::vector<SmallBody*>::iterator ib, ib2;
-    CollisionQueue collisions;
-    for (ib = smallBodies_.begin(); ib < smallBodies_.end(); ++ib) {
-        SmallBody* b = *ib;
-        for (int i = 0; i < 4; i++) {
-            vector2p v = b->getVelocity();
-            // Calculate the distance vector to the planet.
-            vector2p d = planet_->getPosition() - b->getPosition();
-            if (i > 0) {
-                v += b->ds_[i - 1].v * dts[i - 1];
-                d += (planet_->getPosition() - b->ds_[i - 1].p) * dts[i - 1];
+    std::vector<Link*>::iterator il;
+    collisions_.clear();
+    for (ip = planets_.begin(); ip < planets_.end(); ++ip) {
+        AstroBody* pl = *ip;
+        pl->rotor_.rotate(vector2p::fromSmallAngle(dt * pl->av_));
+        pl->rotor_.renorm();
+    }
+    if (gravityChanged_) {
+        gravity_.build(planets_);
+        gravityChanged_ = false;
+    }
+    updateRates(h);
+    // Step through the substeps. Each body is integrated over its own span
+    // of substeps, and all spans end at the end of the step.
+    for (int sub = 0; sub < n; ++sub) {
+        CollisionQueue collisions;
+        for (ib = smallBodies_.begin(); ib < smallBodies_.end(); ++ib) {
+            SmallBody* b = *ib;
+            phys_t radius = boundingRadius(b), t, clear;
+            vector2p p, nm;
+            if (sub % b->span_ == 0) {
+                b->spanStart_ = sub;
+                integrate(b, h * b->span_);
+                // Only the planets near the circle swept by the body over
+                // its span can be hit or crowd it.
+                vector2p from = b->getPosition(), to = b->nextState_.l.p;
+                phys_t reach = (to - from).length() * 0.5 + radius +
+                        _FREE_FLIGHT_CLEARANCE;
+                nearPlanets_.clear();
+                gravity_.getNear((from + to) * 0.5, reach, nearPlanets_);
+                for (ip = nearPlanets_.begin(); ip < nearPlanets_.end();
+                        ++ip) {
+                    AstroBody* pl = *ip;
+                    bodystate np = { pl->s_, pl->rotor_, pl->av_ };
+                    bodystate np2 = np, bs = b->nextState_;
+                    clear = boundingRadius(pl) + radius +
+                            _FREE_FLIGHT_CLEARANCE;
+                    if ((bs.l.p - pl->getPosition()).squared() <
+                            clear * clear)
+                        b->crowded_ = true;
+                    if (collide(pl, b, np, b->getBodyState(), np2, bs, t, p,
+                            nm)) {
+                        Collision c = { sub + t * b->span_, pl, b, np2, bs,
+                                p, nm };
+                        collisions.add(c);
+                    }
+                }
+            }
+            for (ib2 = smallBodies_.begin(); ib2 < ib; ++ib2) {
+                SmallBody* b2 = *ib2;
+                if (b->collisionGroup_ == b2->collisionGroup_)
+                    continue;
+                // Test the pair over the shorter of the two spans.
+                int m = min<int> (b->span_, b2->span_);
+                if (sub % m)
+                    continue;
+                bodystate bs = b->getStateAt(sub + m);
+                bodystate b2s = b2->getStateAt(sub + m);
+                clear = radius + boundingRadius(b2) + _FREE_FLIGHT_CLEARANCE;
+                if ((bs.l.p - b2s.l.p).squared() < clear * clear)
+                    b->crowded_ = b2->crowded_ = true;
+                if (collide(b2, b, b2->getStateAt(sub), b->getStateAt(sub),
+                        b2s, bs, t, p, nm)) {
+                    Collision c = { sub + t * m, b2, b, b2s, bs, p, nm };
+                    collisions.add(c);
+                }
             }
-            // Set initial values for the delta state.
-            b->setDeltaState(i, v);
-            // Calculate acceleration and update delta velocity.
-            phys_t dd = d.squared();
-            b->ds_[i].v += d * (planet_->gm / (sqrt<phys_t> (dd) * dd));
         }
-        bodystate np = { planet_->s_, state1p()(planet_->orientation_,
-                planet_->getAngularVelocity()) };
-        bodystate bs = b->getNextState(dt), ns = bs;
-        b->nextState_ = ns;
-        phys_t t;
-        vector2p p, n;
-        if (collide(planet_, b, np, bs, t, p, n)) {
-            Collision c = { t, planet_, b, np, bs, p, n };
-            collisions.add(c);
+        while (!collisions.empty()) {
+            Collision c = collisions.pop();
+            SmallBody* body1 = (SmallBody*) c.body[1];
+            body1->setBodyState(c.state[1]);
+            vector2p pos1 = c.position + c.state[0].l.p - c.state[1].l.p;
+            vector2p impulse;
+            if (c.body[0]->getInvMass() == 0) {
+                impulse = -bounce1(body1, c.body[0], pos1, c.position,
+                        -c.normal, 0.8, 0.2, 0.1 / (1.0 / pos1.length() +
+                        1.0 / c.position.length()), 0.05);
+            }
+            else {
+                SmallBody* body0 = (SmallBody*) c.body[0];
+                body0->setBodyState(c.state[0]);
+                impulse = bounce2(body0, body1, c.position, pos1, c.normal,
+                        1.25, 0.2, 0.02, 0.05);
+                body0->applyImpulseAndRewind(impulse, c.position, h, c.time);
+            }
+            body1->applyImpulseAndRewind(-impulse, pos1, h, c.time);
+            collisionHandler_.collide(c.body[0], body1, impulse.length());
+            CollisionEvent e = { { c.body[0], body1 },
+                    c.state[0].l.p + c.position, impulse.length() };
+            collisions_.push_back(e);
+            // TODO: Update collision queue
         }
-        for (ib2 = smallBodies_.begin(); ib2 < ib; ++ib2) {
-            SmallBody* b2 = *ib2;
-            if (b->collisionGroup_ == b2->collisionGroup_)
+        // The bodies whose spans end cast their rays in one batch, and then
+        // interact with their primaries.
+        probes_.clear();
+        probeBodies_.clear();
+        for (ib = smallBodies_.begin(); ib < smallBodies_.end(); ++ib) {
+            SmallBody* b = *ib;
+            if ((sub + 1) % b->span_)
                 continue;
-            bs = ns;
-            bodystate b2s = b2->nextState_;
-            if (collide(b2, b, b2s, bs, t, p, n)) {
-                Collision c = { t, b2, b, b2s, bs, p, n };
-                collisions.add(c);
+            b->setBodyState(b->nextState_);
+            b->interacting_ = false;
+            RayQuery q;
+            if (b->primary_ && b->probe(b->primary_, q)) {
+                probes_.push_back(q);
+                probeBodies_.push_back(b);
             }
         }
-    }
-    while (!collisions.empty()) {
-        Collision c = collisions.pop();
-        CollisionHandler* collisionHandler = CollisionHandler::getInstance();
-        SmallBody* body1 = (SmallBody*) c.body[1];
-        body1->setBodyState(c.state[1]);
-        vector2p pos1 = c.position + c.state[0].l.p - c.state[1].l.p;
-        vector2p impulse;
-        if (c.body[0]->getInvMass() == 0) {
-            impulse = -bounce1(body1, c.body[0], pos1, c.position, -c.normal,
-                    0.8, 0.2, 0.1 / (1.0 / pos1.length() + 1.0 /
-                    c.position.length()), 0.05);
+        int np = probes_.size();
+        probeHits_.resize(np);
+        if (np)
+            castRays(&probes_[0], &probeHits_[0], np);
+        for (int i = 0; i < np; ++i) {
+            SmallBody* b = probeBodies_[i];
+            vector2p pg, im;
+            b->interacting_ = b->interact(b->primary_, probeHits_[i],
+                    h * b->span_, pg, im);
+            if (b->interacting_) {
+                b->applyImpulseAt(im, pg - b->getPosition());
+                b->orbiting_ = false;
+            }
         }
-        else {
-            SmallBody* body0 = (SmallBody*) c.body[0];
-            body0->setBodyState(c.state[0]);
-            impulse = bounce2(body0, body1, c.position, pos1, c.normal,
-                    1.25, 0.2, 0.02, 0.05);
-            body0->applyImpulseAndRewind(impulse, c.position, dt, c.time);
+        // Enabled links only join bodies that share a span.
+        springs_.update(sub, h);
+        for (il = links_.begin(); il < links_.end(); ++il) {
+            int span = (*il)->a_->span_;
+            if (!linkAttached_[il - links_.begin()] && (sub + 1) % span == 0)
+                (*il)->update(h * span, this);
         }
-        body1->applyImpulseAndRewind(-impulse, pos1, dt, c.time);
-        collisionHandler->collide(c.body[0], body1, impulse.length());
-        // TODO: Update collision queue
+    }
+}
+
+void GameUniverse::updateRates(phys_t h) {
+    std::vector<SmallBody*>::iterator ib;
+    std::vector<Link*>::iterator il;
+    for (ib = smallBodies_.begin(); ib < smallBodies_.end(); ++ib)
+        (*ib)->bound_ = false;
+    for (il = links_.begin(); il < links_.end(); ++il) {
+        if (!linkAttached_[il - links_.begin()] && (*il)->isEnabled())
+            (*il)->a_->bound_ = (*il)->b_->bound_ = true;
+    }
+    int ns = springs_.getNumSprings();
+    for (int i = 0; i < ns; ++i) {
+        if (springs_.enabled_[i])
+            springs_.a_[i]->bound_ = springs_.b_[i]->bound_ = true;
     }
     for (ib = smallBodies_.begin(); ib < smallBodies_.end(); ++ib) {
         SmallBody* b = *ib;
-        b->setBodyState(b->nextState_);
-        vector2p pg, im;
-        if (b->interact(planet_, dt, pg, im))
-            b->applyImpulseAt(im, pg - b->getPosition());
+        vector2p p = b->getPosition();
+        AstroBody* primary = gravity_.getStrongest(p);
+        if (primary != b->primary_) {
+            b->primary_ = primary;
+            b->orbiting_ = false;
+        }
+        b->freeFlying_ = primary && b->isFreeFlying();
+        if (b->freeFlying_) {
+            // The orbit ignores the other planets, so they must be faint.
+            vector2p d = primary->getPosition() - p;
+            phys_t dd = d.squared();
+            vector2p g = d * (primary->gm / (sqrt<phys_t> (dd) * dd));
+            b->freeFlying_ = (gravity_.getAcceleration(p) - g).squared() <=
+                    _MAX_ORBIT_PERTURBATION * _MAX_ORBIT_PERTURBATION *
+                    g.squared();
+        }
+        // Bodies in or near contact need the finest step.
+        if (b->interacting_ || b->crowded_)
+            b->span_ = 1;
+        else
+            b->span_ = getSpan(b->getVelocity().length() /
+                    _MAX_STEP_TRAVEL, h);
+        b->crowded_ = false;
+    }
+    // Linked bodies form islands sharing the finest span of any member or
+    // link.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (il = links_.begin(); il < links_.end(); ++il) {
+            Link* l = *il;
+            if (linkAttached_[il - links_.begin()])
+                continue;
+            if (l->isEnabled() && joinSpans(l->a_, l->b_,
+                    getSpan(l->getRate() / _MAX_STEP_PHASE, h)))
+                changed = true;
+        }
+        for (int i = 0; i < ns; ++i) {
+            if (springs_.enabled_[i] && joinSpans(springs_.a_[i],
+                    springs_.b_[i], getSpan(springs_.getRate(i) /
+                    _MAX_STEP_PHASE, h)))
+                changed = true;
+        }
     }
-    std::vector<Link*>::iterator il;
-    for (il = links_.begin(); il < links_.end(); ++il)
-        (*il)->update(dt, this);
 }
 
-void GameUniverse::addBody(SmallBody* b) {
+bool GameUniverse::joinSpans(SmallBody* a, SmallBody* b, int span) {
+    span = min<int> (min<int> (a->span_, b->span_), span);
+    if (a->span_ == span && b->span_ == span)
+        return false;
+    a->span_ = b->span_ = span;
+    return true;
+}
+
+int GameUniverse::getSpan(phys_t rate, phys_t h) {
+    int span = 1 << _MAX_RATE_LEVEL;
+    while (span > 1 && rate * h * span > 1)
+        span >>= 1;
+    return span;
+}
+
+void GameUniverse::integrate(SmallBody* b, phys_t dt) {
+    // Bodies that only feel their primary's gravity follow an exact orbit.
+    if (b->freeFlying_) {
+        b->nextState_ = b->getOrbitState(b->primary_, dt);
+        return;
+    }
+    const phys_t dts[] = { dt / 2, dt / 2, dt };
+    b->orbiting_ = false;
+    for (int i = 0; i < 4; i++) {
+        vector2p v = b->getVelocity(), p = b->getPosition();
+        if (i > 0) {
+            v += b->ds_[i - 1].v * dts[i - 1];
+            p += b->ds_[i - 1].p * dts[i - 1];
+        }
+        // Set initial values for the delta state.
+        b->setDeltaState(i, v);
+        // Calculate acceleration and update delta velocity.
+        b->ds_[i].v += gravity_.getAcceleration(p);
+    }
+    b->nextState_ = b->getNextState(dt);
+}
+
+void GameUniverse::addPlanet(AstroBody* p) {
+    planets_.push_back(p);
+    gravityChanged_ = true;
+}
+
+Handle GameUniverse::addBody(SmallBody* b) {
     smallBodies_.push_back(b);
+    know(knownBodies_, b);
+    know(knownMaterials_, b->material_);
+    return bodyHandles_.add();
 }
 
-void GameUniverse::addLink(Link* l) {
+bool GameUniverse::removeBody(Handle h) {
+    int i = bodyHandles_.remove(h);
+    if (i < 0)
+        return false;
+    smallBodies_[i] = smallBodies_.back();
+    smallBodies_.pop_back();
+    return true;
+}
+
+Handle GameUniverse::addLink(Link* l) {
     links_.push_back(l);
+    know(knownLinks_, l);
+    linkAttached_.push_back(l->attach(&springs_));
+    return linkHandles_.add();
+}
+
+bool GameUniverse::removeLink(Handle h) {
+    int i = linkHandles_.remove(h);
+    if (i < 0)
+        return false;
+    if (linkAttached_[i])
+        links_[i]->detach(&springs_);
+    links_[i] = links_.back();
+    links_.pop_back();
+    linkAttached_[i] = linkAttached_.back();
+    linkAttached_.pop_back();
+    return true;
+}
+
+void GameUniverse::addMaterial(Material* m) {
+    know(knownMaterials_, m);
+}
+
+void GameUniverse::reserve(int bodies, int links) {
+    smallBodies_.reserve(bodies);
+    knownBodies_.reserve(bodies);
+    knownLinks_.reserve(links);
+    bodyHandles_.reserve(bodies);
+    links_.reserve(links);
+    linkAttached_.reserve(links);
+    linkHandles_.reserve(links);
 }
 
 void GameUniverse::applyImpulse(SmallBody* a, SmallBody* b, vector2p im,
@@ -172,49 +541,419 @@ void GameUniverse::applyAngularImpulse(SmallBody* a, SmallBody* b, phys_t im) {
     b->applyAngularImpulse(-im);
 }
 
+void GameUniverse::castRays(const RayQuery* rays, RayHit* hits, int n) {
+    // Gather the bounding circles of the small bodies once for the batch,
+    // if any ray can hit them.
+    int m = 0;
+    for (int i = 0; i < n && !m; ++i)
+        m = rays[i].planetsOnly ? 0 : smallBodies_.size();
+    queryX_.resize(m);
+    queryY_.resize(m);
+    queryRr_.resize(m);
+    queryT_.resize(m);
+    for (int k = 0; k < m; ++k) {
+        vector2p p = smallBodies_[k]->getPosition();
+        phys_t r = boundingRadius(smallBodies_[k]);
+        queryX_[k] = p.x;
+        queryY_[k] = p.y;
+        queryRr_[k] = r * r;
+    }
+    for (int i = 0; i < n; ++i) {
+        const RayQuery& q = rays[i];
+        RayHit& h = hits[i];
+        h.t = q.length;
+        h.body = NULL;
+        // Only the planets near a segment can be hit by it.
+        nearPlanets_.clear();
+        if (q.length < std::numeric_limits<phys_t>::infinity())
+            gravity_.getNear(q.origin + q.dir * (q.length * 0.5),
+                    q.length * 0.5, nearPlanets_);
+        else
+            nearPlanets_ = planets_;
+        for (std::vector<AstroBody*>::iterator ip = nearPlanets_.begin();
+                ip < nearPlanets_.end(); ++ip) {
+            phys_t t;
+            vector2p nm;
+            if ((*ip)->castRay(q.origin, q.dir, t, nm) && t < h.t) {
+                h.t = t;
+                h.normal = nm;
+                h.body = *ip;
+            }
+        }
+        if (!q.planetsOnly && m) {
+            intersectRayCircles(q.origin, q.dir, &queryX_[0], &queryY_[0],
+                    &queryRr_[0], m, &queryT_[0]);
+            for (int k = 0; k < m; ++k) {
+                if (queryT_[k] < h.t &&
+                        smallBodies_[k]->collisionGroup_ != q.ignoreGroup) {
+                    h.t = queryT_[k];
+                    h.normal = (q.origin + q.dir * h.t - vector2p()(
+                            queryX_[k], queryY_[k])).unit();
+                    h.body = smallBodies_[k];
+                }
+            }
+        }
+        if (!h.body) {
+            h.t = std::numeric_limits<phys_t>::infinity();
+            h.normal(0, 0);
+        }
+    }
+}
+
+const std::vector<CollisionEvent>& GameUniverse::getCollisions() {
+    return collisions_;
+}
+
+CollisionHandler* GameUniverse::getCollisionHandler() {
+    return &collisionHandler_;
+}
+
+int GameUniverse::newCollisionGroup() {
+    return collisionGroups_++;
+}
+
+void GameUniverse::save(Snapshot& s) {
+    // Planets only spin.
+    for (std::vector<AstroBody*>::iterator i = planets_.begin();
+            i != planets_.end(); ++i) {
+        s.write((*i)->rotor_);
+        s.write((*i)->av_);
+    }
+    s.writeIndices(smallBodies_, knownBodies_);
+    bodyHandles_.save(s);
+    for (std::vector<SmallBody*>::iterator i = smallBodies_.begin();
+            i != smallBodies_.end(); ++i)
+        (*i)->save(s, knownMaterials_, planets_);
+    s.writeIndices(links_, knownLinks_);
+    s.write(linkAttached_);
+    linkHandles_.save(s);
+    springs_.save(s, knownBodies_);
+}
+
+void GameUniverse::restore(Snapshot& s) {
+    for (std::vector<AstroBody*>::iterator i = planets_.begin();
+            i != planets_.end(); ++i) {
+        s.read((*i)->rotor_);
+        s.read((*i)->av_);
+    }
+    s.readIndices(smallBodies_, knownBodies_);
+    bodyHandles_.restore(s);
+    for (std::vector<SmallBody*>::iterator i = smallBodies_.begin();
+            i != smallBodies_.end() && s.isGood(); ++i)
+        (*i)->restore(s, knownMaterials_, planets_);
+    s.readIndices(links_, knownLinks_);
+    s.read(linkAttached_);
+    linkHandles_.restore(s);
+    springs_.restore(s, knownBodies_);
+    for (std::vector<Link*>::iterator il = links_.begin();
+            il != links_.end() && s.isGood(); ++il)
+        if (linkAttached_[il - links_.begin()])
+            (*il)->resume(&springs_);
+}
+
 Link::Link(SmallBody* a, SmallBody* b) :
         a_(a),
         b_(b) {
 }
 
+bool Link::attach(LinkSolver* s) {
+    return false;
+}
+
+void Link::detach(LinkSolver* s) {
+}
+
+void Link::resume(LinkSolver* s) {
+}
+
+void Link::update(phys_t dt, GameUniverse* u) {
+}
+
+bool Link::isEnabled() {
+    return true;
+}
+
+phys_t Link::getRate() {
+    return 0.0;
+}
+
 FixtureSpring::FixtureSpring(SmallBody* a, SmallBody* b, phys_t lStiff,
         phys_t lDamp, phys_t aStiff, phys_t aDamp) :
-    Link(a, b), lStiff_(lStiff), lDamp_(lDamp), aStiff_(aStiff), aDamp_(aDamp),
-            position_(vector2p()(0, 0)), orientation_(0.0), enabled_(true) {
+    Link(a, b), enabled_(true), lStiff_(lStiff), lDamp_(lDamp),
+            aStiff_(aStiff), aDamp_(aDamp), position_(vector2p()(0, 0)),
+            rotor_(vector2p()(1, 0)), solver_(NULL), handle_() {
 }
 
 void FixtureSpring::setEnabled(bool status) {
     enabled_ = status;
+    if (solver_)
+        solver_->setEnabled(handle_, status);
+}
+
+bool FixtureSpring::isEnabled() {
+    return enabled_;
+}
+
+phys_t FixtureSpring::getRate() {
+    phys_t im = a_->getInvMass() + b_->getInvMass();
+    phys_t ii = 1 / a_->getMomentOfInertia() + 1 / b_->getMomentOfInertia();
+    return max<phys_t> (max<phys_t> (sqrt<phys_t> (lStiff_ * im),
+            lDamp_ * im), max<phys_t> (sqrt<phys_t> (aStiff_ * ii),
+            aDamp_ * ii));
 }
 
 void FixtureSpring::setPosition(vector2p position) {
     position_ = position;
+    if (solver_)
+        solver_->setTarget(handle_, position_, rotor_);
 }
 
 void FixtureSpring::setOrientation(phys_t orientation) {
-    orientation_ = orientation;
+    rotor_ = vector2p::fromAngle(orientation);
+    if (solver_)
+        solver_->setTarget(handle_, position_, rotor_);
 }
 
 state2p FixtureSpring::getTargetState() {
-    phys_t orientation = a_->getOrientation();
-    vector2p offset = position_.rotated(
-            vector2p()(cos(orientation), sin(orientation)));
+    vector2p offset = position_.rotated(a_->getRotor());
     state2p r;
     r.p = a_->getPosition() + offset;
     r.v = a_->getVelocityAt(offset);
     return r;
 }
 
-void FixtureSpring::update(phys_t dt, GameUniverse* u) {
-    if (!enabled_)
+bool FixtureSpring::attach(LinkSolver* s) {
+    solver_ = s;
+    handle_ = s->add(a_, b_, lStiff_, lDamp_, aStiff_, aDamp_);
+    s->setEnabled(handle_, enabled_);
+    s->setTarget(handle_, position_, rotor_);
+    return true;
+}
+
+void FixtureSpring::detach(LinkSolver* s) {
+    s->remove(handle_);
+    solver_ = NULL;
+}
+
+void FixtureSpring::resume(LinkSolver* s) {
+    solver_ = s;
+}
+
+void FixtureSpring::save(Snapshot& s) {
+    bool attached = solver_ != NULL;
+    s.write(enabled_);
+    s.write(position_);
+    s.write(rotor_);
+    s.write(attached);
+}
+
+void FixtureSpring::restore(Snapshot& s) {
+    bool attached = false;
+    s.read(enabled_);
+    s.read(position_);
+    s.read(rotor_);
+    s.read(attached);
+    // The universe resumes the spring if it was attached; the handle it got
+    // then is still valid, as the solver's handles are restored with it.
+    if (!attached)
+        solver_ = NULL;
+}
+
+LinkSolver::LinkSolver() :
+        springs_(),
+        a_(),
+        b_(),
+        enabled_(),
+        lStiff_(),
+        lDamp_(),
+        aStiff_(),
+        aDamp_(),
+        px_(),
+        py_(),
+        rx_(),
+        ry_(),
+        ax_(),
+        ay_(),
+        avx_(),
+        avy_(),
+        arx_(),
+        ary_(),
+        aw_(),
+        bx_(),
+        by_(),
+        bvx_(),
+        bvy_(),
+        brx_(),
+        bry_(),
+        bw_(),
+        dt_(),
+        imx_(),
+        imy_(),
+        ta_(),
+        tb_() {
+}
+
+Handle LinkSolver::add(SmallBody* a, SmallBody* b, phys_t lStiff,
+        phys_t lDamp, phys_t aStiff, phys_t aDamp) {
+    a_.push_back(a);
+    b_.push_back(b);
+    enabled_.push_back(true);
+    lStiff_.push_back(lStiff);
+    lDamp_.push_back(lDamp);
+    aStiff_.push_back(aStiff);
+    aDamp_.push_back(aDamp);
+    px_.push_back(0.0);
+    py_.push_back(0.0);
+    rx_.push_back(1.0);
+    ry_.push_back(0.0);
+    resizeGathered();
+    return springs_.add();
+}
+
+void LinkSolver::remove(Handle h) {
+    int i = springs_.remove(h);
+    if (i < 0)
+        return;
+    a_[i] = a_.back();
+    a_.pop_back();
+    b_[i] = b_.back();
+    b_.pop_back();
+    enabled_[i] = enabled_.back();
+    enabled_.pop_back();
+    std::vector<phys_t>* params[] = { &lStiff_, &lDamp_, &aStiff_, &aDamp_,
+            &px_, &py_, &rx_, &ry_ };
+    for (unsigned int k = 0; k < sizeof(params) / sizeof(*params); ++k) {
+        std::vector<phys_t>& p = *params[k];
+        p[i] = p.back();
+        p.pop_back();
+    }
+    resizeGathered();
+}
+
+void LinkSolver::resizeGathered() {
+    std::vector<phys_t>* gathered[] = { &ax_, &ay_, &avx_, &avy_, &arx_,
+            &ary_, &aw_, &bx_, &by_, &bvx_, &bvy_, &brx_, &bry_, &bw_, &dt_,
+            &imx_, &imy_, &ta_, &tb_ };
+    for (unsigned int k = 0; k < sizeof(gathered) / sizeof(*gathered); ++k)
+        gathered[k]->resize(a_.size());
+}
+
+int LinkSolver::getNumSprings() {
+    return a_.size();
+}
+
+bool LinkSolver::isEnabled(Handle h) {
+    int i = springs_.find(h);
+    return i >= 0 && enabled_[i];
+}
+
+void LinkSolver::setEnabled(Handle h, bool enabled) {
+    int i = springs_.find(h);
+    if (i >= 0)
+        enabled_[i] = enabled;
+}
+
+void LinkSolver::setTarget(Handle h, vector2p position, vector2p rotor) {
+    int i = springs_.find(h);
+    if (i < 0)
         return;
-    state2p target = getTargetState();
-    state2p d = b_->getState() - target;
-    vector2p n = d.p.unit();
-    vector2p im = (d.p * lStiff_ + n * (d.v * n * lDamp_)) * dt;
-    u->applyImpulse(a_, b_, im, target.p - a_->getPosition());
-    phys_t da = b_->getOrientation() - a_->getOrientation() + orientation_;
-    da = remainder<phys_t> (da, 2 * PI);
-    phys_t dav = b_->getAngularVelocity() - a_->getAngularVelocity();
-    u->applyAngularImpulse(a_, b_, (da * aStiff_ + dav * aDamp_) * dt);
+    px_[i] = position.x;
+    py_[i] = position.y;
+    rx_[i] = rotor.x;
+    ry_[i] = rotor.y;
+}
+
+phys_t LinkSolver::getRate(int i) {
+    SmallBody* a = a_[i], * b = b_[i];
+    phys_t im = a->getInvMass() + b->getInvMass();
+    phys_t ii = 1 / a->getMomentOfInertia() + 1 / b->getMomentOfInertia();
+    return max<phys_t> (max<phys_t> (sqrt<phys_t> (lStiff_[i] * im),
+            lDamp_[i] * im), max<phys_t> (sqrt<phys_t> (aStiff_[i] * ii),
+            aDamp_[i] * ii));
+}
+
+void LinkSolver::save(Snapshot& s, const std::vector<SmallBody*>& bodies) {
+    springs_.save(s);
+    s.writeIndices(a_, bodies);
+    s.writeIndices(b_, bodies);
+    s.write(enabled_);
+    std::vector<phys_t>* params[] = { &lStiff_, &lDamp_, &aStiff_, &aDamp_,
+            &px_, &py_, &rx_, &ry_ };
+    for (unsigned int k = 0; k < sizeof(params) / sizeof(*params); ++k)
+        s.write(*params[k]);
+}
+
+void LinkSolver::restore(Snapshot& s,
+        const std::vector<SmallBody*>& bodies) {
+    springs_.restore(s);
+    s.readIndices(a_, bodies);
+    s.readIndices(b_, bodies);
+    s.read(enabled_);
+    std::vector<phys_t>* params[] = { &lStiff_, &lDamp_, &aStiff_, &aDamp_,
+            &px_, &py_, &rx_, &ry_ };
+    for (unsigned int k = 0; k < sizeof(params) / sizeof(*params); ++k)
+        s.read(*params[k]);
+    resizeGathered();
+}
+
+void LinkSolver::update(int sub, phys_t h) {
+    const int n = a_.size();
+    // Gather the states of the springs due this substep.
+    for (int i = 0; i < n; ++i) {
+        SmallBody* a = a_[i], * b = b_[i];
+        bool due = enabled_[i] && (sub + 1) % a->span_ == 0;
+        dt_[i] = due ? h * a->span_ : 0.0;
+        if (!due)
+            continue;
+        ax_[i] = a->s_.p.x;
+        ay_[i] = a->s_.p.y;
+        avx_[i] = a->s_.v.x;
+        avy_[i] = a->s_.v.y;
+        arx_[i] = a->rotor_.x;
+        ary_[i] = a->rotor_.y;
+        aw_[i] = a->av_;
+        bx_[i] = b->s_.p.x;
+        by_[i] = b->s_.p.y;
+        bvx_[i] = b->s_.v.x;
+        bvy_[i] = b->s_.v.y;
+        brx_[i] = b->rotor_.x;
+        bry_[i] = b->rotor_.y;
+        bw_[i] = b->av_;
+    }
+    // Compute every impulse. Springs that are not due have a zero step.
+    const phys_t tiny = std::numeric_limits<phys_t>::min();
+    for (int i = 0; i < n; ++i) {
+        // Target of b: the offset rotated by a's rotor, moving with a.
+        phys_t ox = px_[i] * arx_[i] - py_[i] * ary_[i];
+        phys_t oy = px_[i] * ary_[i] + py_[i] * arx_[i];
+        phys_t dx = bx_[i] - ax_[i] - ox, dy = by_[i] - ay_[i] - oy;
+        phys_t dvx = bvx_[i] - avx_[i] + oy * aw_[i];
+        phys_t dvy = bvy_[i] - avy_[i] - ox * aw_[i];
+        // Stiffness along the offset, and damping along its direction.
+        phys_t dd = max<phys_t> (dx * dx + dy * dy, tiny);
+        phys_t k = (lStiff_[i] + lDamp_[i] * (dvx * dx + dvy * dy) / dd) *
+                dt_[i];
+        phys_t ix = dx * k, iy = dy * k;
+        // Angle of b relative to a, plus the target angle.
+        phys_t qx = brx_[i] * arx_[i] + bry_[i] * ary_[i];
+        phys_t qy = bry_[i] * arx_[i] - brx_[i] * ary_[i];
+        phys_t da = FastMath::atan2<phys_t> (qx * ry_[i] + qy * rx_[i],
+                qx * rx_[i] - qy * ry_[i]);
+        phys_t ai = (da * aStiff_[i] + (bw_[i] - aw_[i]) * aDamp_[i]) *
+                dt_[i];
+        imx_[i] = ix;
+        imy_[i] = iy;
+        ta_[i] = ox * iy - oy * ix + ai;
+        tb_[i] = dx * iy - dy * ix - ai;
+    }
+    // Scatter the impulses, in order, as springs may share bodies.
+    for (int i = 0; i < n; ++i) {
+        if (dt_[i] == 0.0)
+            continue;
+        vector2p im = { imx_[i], imy_[i] };
+        a_[i]->applyImpulse(im);
+        a_[i]->applyAngularImpulse(ta_[i]);
+        b_[i]->applyImpulse(-im);
+        b_[i]->applyAngularImpulse(tb_[i]);
+    }
 }
@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <time.h>
+#include "game_server.hxx"
+
+/** Tags and versions of input packets and state packets. */
+static const unsigned char INPUT_MAGIC[] = { 'L', 'C', 1 };
+static const unsigned char STATE_MAGIC[] = { 'L', 'S', 1 };
+/**
+ * Input packets hold the tag, a byte of padding, the newest tick received
+ * plus one, a sequence number, and the input. State packets hold the tag,
+ * the client's player or 255, the tick, the tick coded against plus one,
+ * and the coded frame.
+ */
+static const int INPUT_PACKET_SIZE = 16, STATE_HEADER_SIZE = 12;
+/** Max size of a state packet. */
+static const int MAX_STATE_SIZE = 8192;
+static const unsigned char NO_PLAYER = 0xff;
+
+GameServer::GameServer(Game* game, int tickInterval) :
+        game_(game),
+        socket_(),
+        tickInterval_(max(tickInterval, 1)),
+        step_(0),
+        clients_(),
+        packet_(),
+        bytes_(0),
+        busy_(0),
+        ticks_(0),
+        clientTicks_(0) {
+    // Nobody plays on the server itself.
+    game_->getInputRouter()->clear();
+    for (int i = 0; i < _HISTORY; ++i)
+        frames_[i].setTick(-1);
+    packet_.reserve(MAX_STATE_SIZE);
+}
+
+bool GameServer::open(unsigned short port) {
+    return socket_.open(port);
+}
+
+void GameServer::update(phys_t dt) {
+    clock_t start = clock();
+    receive();
+    game_->step(dt);
+    if (++step_ % tickInterval_ == 0)
+        broadcast();
+    busy_ += (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+int GameServer::getNumClients() {
+    return clients_.size();
+}
+
+double GameServer::getBytesPerClient() {
+    return clientTicks_ ? bytes_ / clientTicks_ : 0.0;
+}
+
+double GameServer::getTickTime() {
+    return ticks_ ? busy_ / ticks_ : 0.0;
+}
+
+void GameServer::resetStats() {
+    bytes_ = busy_ = 0;
+    ticks_ = clientTicks_ = 0;
+}
+
+void GameServer::receive() {
+    unsigned char buffer[INPUT_PACKET_SIZE];
+    sockaddr_in from;
+    int n;
+    while ((n = socket_.receive(buffer, sizeof(buffer), &from)) >= 0) {
+        if (n != INPUT_PACKET_SIZE ||
+                memcmp(buffer, INPUT_MAGIC, sizeof(INPUT_MAGIC)))
+            continue;
+        Client* c = NULL;
+        for (std::vector<Client>::iterator i = clients_.begin();
+                i != clients_.end(); ++i) {
+            if (UdpSocket::isSameAddress(i->address, from))
+                c = &*i;
+        }
+        if (!c) {
+            if ((int) clients_.size() >= _MAX_CLIENTS)
+                continue;
+            Client k;
+            StepInput none = { 0, 0, 0 };
+            k.address = from;
+            k.player = -1;
+            k.acked = -1;
+            k.sequence = 0;
+            k.input = none;
+            // Take the first player nobody controls, if any.
+            for (int p = 0; p < game_->getNumPlayers() && k.player < 0;
+                    ++p) {
+                bool taken = false;
+                for (std::vector<Client>::iterator i = clients_.begin();
+                        i != clients_.end(); ++i)
+                    taken = taken || i->player == p;
+                if (!taken)
+                    k.player = p;
+            }
+            clients_.push_back(k);
+            c = &clients_.back();
+        }
+        c->heard = step_;
+        c->acked = max(c->acked, (int) UdpSocket::getU32(buffer + 4) - 1);
+        unsigned int sequence = UdpSocket::getU32(buffer + 8);
+        if (sequence <= c->sequence)
+            continue;
+        c->sequence = sequence;
+        StepInput input;
+        input.held = buffer[12] | buffer[13] << 8;
+        input.left = buffer[14];
+        input.right = buffer[15];
+        if (c->player >= 0)
+            input.apply(game_->getPlayer(c->player), c->input);
+        c->input = input;
+    }
+    // Drop the clients that have gone quiet, letting go of their controls.
+    for (int i = clients_.size() - 1; i >= 0; --i) {
+        if (step_ - clients_[i].heard < _TIMEOUT)
+            continue;
+        StepInput none = { 0, 0, 0 };
+        if (clients_[i].player >= 0)
+            none.apply(game_->getPlayer(clients_[i].player),
+                    clients_[i].input);
+        clients_.erase(clients_.begin() + i);
+    }
+}
+
+void GameServer::broadcast() {
+    StateFrame& f = frames_[step_ / tickInterval_ % _HISTORY];
+    game_->getFrame(f);
+    f.setTick(step_);
+    for (std::vector<Client>::iterator i = clients_.begin();
+            i != clients_.end(); ++i) {
+        StateFrame* base = findFrame(i->acked);
+        if (base && base->getNumCharacters() != f.getNumCharacters())
+            base = NULL;
+        packet_.resize(STATE_HEADER_SIZE);
+        memcpy(&packet_[0], STATE_MAGIC, sizeof(STATE_MAGIC));
+        packet_[3] = i->player < 0 ? NO_PLAYER : i->player;
+        UdpSocket::putU32(&packet_[4], step_);
+        UdpSocket::putU32(&packet_[8], base ? base->getTick() + 1 : 0);
+        f.encode(base, packet_);
+        if ((int) packet_.size() > MAX_STATE_SIZE)
+            continue;
+        socket_.send(&packet_[0], packet_.size(), i->address);
+        bytes_ += packet_.size();
+    }
+    ++ticks_;
+    clientTicks_ += clients_.size();
+}
+
+StateFrame* GameServer::findFrame(int tick) {
+    if (tick < 0)
+        return NULL;
+    StateFrame& f = frames_[tick / tickInterval_ % _HISTORY];
+    return f.getTick() == tick ? &f : NULL;
+}
+
+GameClient::GameClient(Game* game) :
+        game_(game),
+        socket_(),
+        player_(-1),
+        numBound_(-1),
+        bound_(-1),
+        next_(0),
+        newest_(-1),
+        tickInterval_(0),
+        time_(-1),
+        shown_(),
+        sequence_(0),
+        sinceSent_(0),
+        received_(false) {
+    StepInput none = { 0, 0, 0 };
+    capture_ = sent_ = none;
+    memset(&server_, 0, sizeof(server_));
+    for (int i = 0; i < _HISTORY; ++i)
+        frames_[i].setTick(-1);
+    bindPlayer();
+}
+
+GameClient::~GameClient() {
+    if (bound_ >= 0 && bound_ < game_->getNumPlayers())
+        game_->getPlayer(bound_)->setCapture(NULL);
+}
+
+bool GameClient::connect(const char* address) {
+    if (!UdpSocket::resolve(address, server_) || !socket_.open(0))
+        return false;
+    send();
+    return true;
+}
+
+void GameClient::update() {
+    receive();
+    if (capture_ != sent_ || received_ || ++sinceSent_ >= _RESEND)
+        send();
+    if (newest_ < 0)
+        return;
+    // Drift towards the time shown behind the newest frame, or jump there
+    // when far off.
+    double target = newest_ - _BEHIND * tickInterval_;
+    if (time_ < 0 || abs(time_ - target) > _HISTORY / 2 * tickInterval_)
+        time_ = target;
+    else
+        time_ += 1 + (target - time_) * 0.01;
+    const StateFrame* a = NULL, * b = NULL;
+    for (int i = 0; i < _HISTORY; ++i) {
+        const StateFrame& f = frames_[i];
+        if (f.getTick() < 0)
+            continue;
+        if (f.getTick() <= time_ && (!a || f.getTick() > a->getTick()))
+            a = &f;
+        if (f.getTick() > time_ && (!b || f.getTick() < b->getTick()))
+            b = &f;
+    }
+    if (a && b)
+        shown_.interpolate(*a, *b, (time_ - a->getTick()) /
+                (b->getTick() - a->getTick()));
+    else
+        shown_ = a ? *a : *b;
+    game_->setFrame(shown_);
+    if (game_->getNumPlayers() != numBound_ || player_ != bound_)
+        bindPlayer();
+    game_->updateGraphics();
+}
+
+void GameClient::receive() {
+    unsigned char buffer[MAX_STATE_SIZE];
+    sockaddr_in from;
+    int n;
+    while ((n = socket_.receive(buffer, sizeof(buffer), &from)) >= 0) {
+        if (n < STATE_HEADER_SIZE ||
+                memcmp(buffer, STATE_MAGIC, sizeof(STATE_MAGIC)) ||
+                !UdpSocket::isSameAddress(from, server_))
+            continue;
+        int tick = UdpSocket::getU32(buffer + 4),
+                baseTick = (int) UdpSocket::getU32(buffer + 8) - 1;
+        // Frames arriving late are of no more use.
+        if (tick <= newest_)
+            continue;
+        const StateFrame* base = NULL;
+        for (int i = 0; i < _HISTORY && baseTick >= 0; ++i) {
+            if (frames_[i].getTick() == baseTick)
+                base = &frames_[i];
+        }
+        if (baseTick >= 0 && !base)
+            continue;
+        StateFrame f;
+        if (f.decode(base, buffer + STATE_HEADER_SIZE,
+                n - STATE_HEADER_SIZE) != n - STATE_HEADER_SIZE)
+            continue;
+        f.setTick(tick);
+        frames_[next_] = f;
+        next_ = (next_ + 1) % _HISTORY;
+        if (newest_ >= 0)
+            tickInterval_ = tickInterval_ ? min(tickInterval_,
+                    tick - newest_) : tick - newest_;
+        newest_ = tick;
+        player_ = buffer[3] == NO_PLAYER ? -1 : buffer[3];
+        received_ = true;
+    }
+}
+
+void GameClient::send() {
+    unsigned char p[INPUT_PACKET_SIZE];
+    memcpy(p, INPUT_MAGIC, sizeof(INPUT_MAGIC));
+    p[3] = 0;
+    UdpSocket::putU32(p + 4, newest_ + 1);
+    UdpSocket::putU32(p + 8, ++sequence_);
+    p[12] = capture_.held & 0xff;
+    p[13] = capture_.held >> 8;
+    p[14] = capture_.left;
+    p[15] = capture_.right;
+    socket_.send(p, sizeof(p), server_);
+    sent_ = capture_;
+    sinceSent_ = 0;
+    received_ = false;
+}
+
+void GameClient::bindPlayer() {
+    if (bound_ >= 0 && bound_ < game_->getNumPlayers())
+        game_->getPlayer(bound_)->setCapture(NULL);
+    numBound_ = game_->getNumPlayers();
+    bound_ = player_ < numBound_ ? player_ : -1;
+    if (bound_ < 0) {
+        game_->getInputRouter()->clear();
+        return;
+    }
+    game_->setLocalPlayer(bound_);
+    game_->getPlayer(bound_)->setCapture(&capture_);
+}
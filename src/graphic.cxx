@@ -24,50 +24,53 @@
 #include "game_graphics_gl.hxx"
 #include "geometry.hxx"
 
-GraphicFixture::GraphicFixture(Body* body) :
-        body_(body) {
+void Graphic::draw() {
+    DrawState state;
+    state.reset();
+    draw(state);
+    Screen::getInstance()->getBatch()->flush();
 }
 
-void GraphicFixture::begin() {
-    phys_t x, y;
-    body_->getPosition(x, y);
-    glPushMatrix();
-    glTranslatef(x, y, 0.0);
-    glRotatef(body_->getOrientation() * IN_DEG, 0.0, 0.0, 1.0);
+GraphicFixture::GraphicFixture(Body* body) :
+        body_(body) {
 }
 
-void GraphicFixture::end() {
-    glPopMatrix();
+void GraphicFixture::modify(DrawState& state) {
+    vector2p p = body_->getPosition(), r = body_->getRotor();
+    // Translate and rotate in one go, straight from the rotor.
+    float t[] = { (float) r.x, (float) r.y, (float) -r.y, (float) r.x,
+            (float) p.x, (float) p.y };
+    state.transform(t);
 }
 
 ColorModifier::ColorModifier(const float* color) :
         color_(color) {
 }
 
-void ColorModifier::begin() {
-    glPushAttrib(GL_CURRENT_BIT | GL_LIGHTING_BIT);
-    glColor3fv(color_);
+void ColorModifier::modify(DrawState& state) {
+    // Keep the opacity, so that fades outside the colour still apply.
+    for (int i = 0; i < 3; ++i)
+        state.colour[i] = color_[i];
 }
 
-void ColorModifier::end() {
-    glPopAttrib();
+FadeModifier::FadeModifier(const float* fade) :
+        fade_(fade) {
+}
+
+void FadeModifier::modify(DrawState& state) {
+    state.colour[3] *= *fade_;
 }
 
 BackgroundModifier::BackgroundModifier(Camera* camera) :
         camera_(camera) {
 }
 
-void BackgroundModifier::begin() {
+void BackgroundModifier::modify(DrawState& state) {
     Screen* s = Screen::getInstance();
     GLfloat w = s->getGlWidth(), h = s->getGlHeight();
     GLfloat r = sqrt(w * w + h * h);
-    glPushMatrix();
-    glScalef(r, r, 1.0);
-    glRotatef(camera_->getRotation(), 0.0, 0.0, -1.0);
-}
-
-void BackgroundModifier::end() {
-    glPopMatrix();
+    state.scale(r, r);
+    state.rotate(-camera_->getRotation());
 }
 
 PositionModifier::PositionModifier(int position, int num, bool horizontalP,
@@ -78,32 +81,27 @@ PositionModifier::PositionModifier(int position, int num, bool horizontalP,
         offset_(offset) {
 }
 
-void PositionModifier::begin() {
-    glPushMatrix();
+void PositionModifier::modify(DrawState& state) {
     // Evenly distribute the elements horizontally or vertically
     GLfloat f = 2.0 / num_ * ((1.0 + num_) / 2.0 - position_);
     if (horizontalP_)
-        glTranslatef(-f, offset_, 0.0);
+        state.translate(-f, offset_);
     else
-        glTranslatef(offset_, f, 0.0);
+        state.translate(offset_, f);
 }
 
-void PositionModifier::end() {
-    glPopMatrix();
+void PositionModifier::setPosition(int position, int num) {
+    position_ = position;
+    num_ = num;
 }
 
 SizeModifier::SizeModifier(Shape<phys_t>* shape) :
-        shape_((Circle<phys_t>*) shape)  {
-}
-
-void SizeModifier::begin() {
-    glPushMatrix();
-    GLfloat f = shape_->getRadius();
-    glScalef(f, f, 1.0);
+        shape_(shape)  {
 }
 
-void SizeModifier::end() {
-    glPopMatrix();
+void SizeModifier::modify(DrawState& state) {
+    GLfloat f = shape_->getBoundingRadius();
+    state.scale(f, f);
 }
 
 StackGraphic::StackGraphic() :
@@ -126,16 +124,16 @@ std::size_t StackGraphic::removeGraphic(Graphic* g) {
     return i;
 }
 
-void StackGraphic::doDraw() {
+void StackGraphic::doDraw(const DrawState& state) {
     // Draw all the graphics in the stack in the correct order.
     if (Screen::getInstance()->getDrawingMode() & Screen::_DM_FRONT_TO_BACK) {
         std::vector<Graphic*>::reverse_iterator i;
         for (i = graphics_.rbegin(); i < graphics_.rend(); ++i)
-            (*i)->draw();
+            (*i)->draw(state);
     } else {
         std::vector<Graphic*>::iterator i;
         for (i = graphics_.begin(); i < graphics_.end(); ++i)
-            (*i)->draw();
+            (*i)->draw(state);
     }
 }
 
@@ -145,23 +143,10 @@ Sprite::Sprite(GLuint texture, GLfloat w, GLfloat h) :
         h_(h) {
 }
 
-void Sprite::doDraw() {
-    Screen::getInstance()->setDrawingMode(-1, Screen::_DM_PREMUL);
-    glPushMatrix();
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, texture_);
-    glBegin(GL_QUADS);
-    glTexCoord2f(0.0, 1.0);
-    glVertex2f(-w_, -h_);
-    glTexCoord2f(1.0, 1.0);
-    glVertex2f(w_, -h_);
-    glTexCoord2f(1.0, 0.0);
-    glVertex2f(w_, h_);
-    glTexCoord2f(0.0, 0.0);
-    glVertex2f(-w_, h_);
-    glEnd();
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glPopMatrix();
+void Sprite::doDraw(const DrawState& state) {
+    DrawBatch* batch = Screen::getInstance()->getBatch();
+    batch->setTexture(texture_, true);
+    batch->addRectangle(state, state.colour, w_, h_);
 }
 
 ScreenGraphic::ScreenGraphic() :
@@ -223,39 +208,19 @@ GLfloat Label::getWidth() {
     return width_;
 }
 
-void Label::doDraw() {
-    Screen::getInstance()->setDrawingMode(0, Screen::_DM_PREMUL);
-    glPushAttrib(GL_CURRENT_BIT | GL_LIGHTING_BIT);
-    glColor3f(1.0, 1.0, 1.0);
-    glBindTexture(GL_TEXTURE_2D, texture_);
-    glBegin(GL_QUADS);
-    glTexCoord2f(.0, 1.);
-    glVertex2f(-width_, -height_);
-    glTexCoord2f(1., 1.);
-    glVertex2f(width_, -height_);
-    glTexCoord2f(1., .0);
-    glVertex2f(width_, height_);
-    glTexCoord2f(.0, .0);
-    glVertex2f(-width_, height_);
-    glEnd();
-    drawShadow();
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glPopAttrib();
+void Label::doDraw(const DrawState& state) {
+    const GLfloat white[] = { 1.0, 1.0, 1.0, 1.0 };
+    DrawBatch* batch = Screen::getInstance()->getBatch();
+    batch->setTexture(texture_, false);
+    batch->addRectangle(state, white, width_, height_);
+    drawShadow(state);
 }
 
-void Label::drawShadow() {
+void Label::drawShadow(const DrawState& state) {
     // TODO: Implement shadow properly...
-    glColor3f(0.0, 0.0, 0.0);
-    glBegin(GL_QUADS);
-    glTexCoord2f(.0, 1.);
-    glVertex2f(-width_ + width_ / 50.0, -height_ - height_ / 10.0);
-    glTexCoord2f(1., 1.);
-    glVertex2f(width_ + width_ / 50.0, -height_ - height_ / 10.0);
-    glTexCoord2f(1., .0);
-    glVertex2f(width_ + width_ / 50.0, height_ - height_ / 10.0);
-    glTexCoord2f(.0, .0);
-    glVertex2f(-width_ + width_ / 50.0, height_ - height_ / 10.0);
-    glEnd();
+    const GLfloat black[] = { 0.0, 0.0, 0.0, 1.0 };
+    Screen::getInstance()->getBatch()->addRectangle(state, black, width_,
+            height_, width_ / 50.0, -height_ / 10.0);
 }
 
 void Label::make() {
@@ -327,39 +292,19 @@ InputFieldGraphic::~InputFieldGraphic() {
     free(text_);
 }
 
-void InputFieldGraphic::doDraw() {
-    Screen::getInstance()->setDrawingMode(0, Screen::_DM_PREMUL);
-    glPushAttrib(GL_CURRENT_BIT | GL_LIGHTING_BIT);
-    glColor3f(1.0, 1.0, 1.0);
-    glBindTexture(GL_TEXTURE_2D, texture_);
-    glBegin(GL_QUADS);
-    glTexCoord2f(0.0, 1.0);
-    glVertex2f(-width_, -height_);
-    glTexCoord2f(1.0, 1.0);
-    glVertex2f(width_, -height_);
-    glTexCoord2f(1.0, 0.0);
-    glVertex2f(width_, height_);
-    glTexCoord2f(0.0, 0.0);
-    glVertex2f(-width_, height_);
-    glEnd();
-    drawShadow();
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glPopAttrib();
+void InputFieldGraphic::doDraw(const DrawState& state) {
+    const GLfloat white[] = { 1.0, 1.0, 1.0, 1.0 };
+    DrawBatch* batch = Screen::getInstance()->getBatch();
+    batch->setTexture(texture_, false);
+    batch->addRectangle(state, white, width_, height_);
+    drawShadow(state);
 }
 
-void InputFieldGraphic::drawShadow() {
+void InputFieldGraphic::drawShadow(const DrawState& state) {
     // TODO: Implement shadow properly...
-    glColor3f(0.0, 0.0, 0.0);
-    glBegin(GL_QUADS);
-    glTexCoord2f(.0, 1.);
-    glVertex2f(-width_ + width_ / 50.0, -height_ - height_ / 10.0);
-    glTexCoord2f(1., 1.);
-    glVertex2f(width_ + width_ / 50.0, -height_ - height_ / 10.0);
-    glTexCoord2f(1., .0);
-    glVertex2f(width_ + width_ / 50.0, height_ - height_ / 10.0);
-    glTexCoord2f(.0, .0);
-    glVertex2f(-width_ + width_ / 50.0, height_ - height_ / 10.0);
-    glEnd();
+    const GLfloat black[] = { 0.0, 0.0, 0.0, 1.0 };
+    Screen::getInstance()->getBatch()->addRectangle(state, black, width_,
+            height_, width_ / 50.0, -height_ / 10.0);
 }
 
 char* InputFieldGraphic::getText() {
@@ -405,35 +350,35 @@ void InputFieldGraphic::make() {
 Disk::Disk(GLfloat r, int n) :
         r_(r),
         n_(n),
-        displayList_(0) {
+        triangles_() {
 }
 
-void Disk::doDraw() {
-    Screen::getInstance()->setDrawingMode(0, Screen::_DM_PREMUL);
-    if (displayList_ == 0)
-        makeDisplayList();
-    else
-        glCallList(displayList_);
+void Disk::doDraw(const DrawState& state) {
+    if (triangles_.empty())
+        makeTriangles();
+    DrawBatch* batch = Screen::getInstance()->getBatch();
+    batch->setTexture(0, false);
+    batch->addTriangles(state, state.colour, &triangles_[0],
+            triangles_.size() / 6);
 }
 
-void Disk::makeDisplayList() {
+void Disk::makeTriangles() {
+    // A fan from the first point of the rim.
     float t = 2 * PI / n_;
     float c = cosf(t), s = sinf(t), x = 0.0, y = r_;
-    displayList_ = glGenLists(1);
-    glNewList(displayList_, GL_COMPILE_AND_EXECUTE);
-    glBegin(GL_TRIANGLE_STRIP);
-    glNormal3f(0.0, 0.0, 1.0);
-    glVertex2f(x, y);
-    for (int i = 1; i < n_; i++) {
-        if (i & 1) {
-            float z = x;
-            x = c * x - s * y;
-            y = s * z + c * y;
-        }
-        glVertex2f(i & 1 ? x : -x, y);
+    std::vector<GLfloat> rim;
+    for (int i = 0; i < n_; i++) {
+        rim.push_back(x);
+        rim.push_back(y);
+        float z = x;
+        x = c * x - s * y;
+        y = s * z + c * y;
+    }
+    for (int i = 2; i < n_; i++) {
+        GLfloat triangle[] = { rim[0], rim[1], rim[i * 2 - 2],
+                rim[i * 2 - 1], rim[i * 2], rim[i * 2 + 1] };
+        triangles_.insert(triangles_.end(), triangle, triangle + 6);
     }
-    glEnd();
-    glEndList();
 }
 
 TestDisk::TestDisk(GLfloat r, int n) :
@@ -451,6 +396,33 @@ Disk* TestDisk::getSquare() {
     return &square_;
 }
 
+TerrainGraphic::TerrainGraphic(Terrain<phys_t>* terrain) :
+        terrain_(terrain),
+        triangles_() {
+}
+
+void TerrainGraphic::doDraw(const DrawState& state) {
+    if (triangles_.empty())
+        makeTriangles();
+    DrawBatch* batch = Screen::getInstance()->getBatch();
+    batch->setTexture(0, false);
+    batch->addTriangles(state, state.colour, &triangles_[0],
+            triangles_.size() / 6);
+}
+
+void TerrainGraphic::makeTriangles() {
+    // The outline need not be convex, so each triangle goes from the
+    // centre to two neighbouring rim points.
+    int n = terrain_->getNumSamples();
+    for (int i = 0; i < n; i++) {
+        vector2p p = terrain_->getPoint(i);
+        vector2p q = terrain_->getPoint((i + 1) % n);
+        GLfloat triangle[] = { (GLfloat) p.x, (GLfloat) p.y, 0.0, 0.0,
+                (GLfloat) q.x, (GLfloat) q.y };
+        triangles_.insert(triangles_.end(), triangle, triangle + 6);
+    }
+}
+
 MassIndicatorGraphic::MassIndicatorGraphic(GLfloat width, GLfloat height,
         MassIndicator* logic, Label* label) :
         label(label) {
@@ -458,17 +430,14 @@ MassIndicatorGraphic::MassIndicatorGraphic(GLfloat width, GLfloat height,
     logic_ = logic;
 }
 
-void MassIndicatorGraphic::doDraw() {
+void MassIndicatorGraphic::doDraw(const DrawState& state) {
     // This draws front to back
     if (label) {
-        label->draw();
+        label->draw(state);
     }
-    glBegin(GL_QUADS);
-    glVertex2f(width_, -height_);
-    glVertex2f(-width_, -height_);
-    glVertex2f(-width_, height_);
-    glVertex2f(width_, height_);
-    glEnd();
+    DrawBatch* batch = Screen::getInstance()->getBatch();
+    batch->setTexture(0, false);
+    batch->addRectangle(state, state.colour, width_, height_);
 }
 
 ButtonGraphic::ButtonGraphic(GLfloat width, GLfloat height, Button* logic,
@@ -481,23 +450,17 @@ ButtonGraphic::ButtonGraphic(GLfloat width, GLfloat height, Button* logic,
 ButtonGraphic::~ButtonGraphic() {
 }
 
-void ButtonGraphic::doDraw() {
+void ButtonGraphic::doDraw(const DrawState& state) {
     // This draws front to back
     if (label) {
-        label->draw();
+        label->draw(state);
     }
-    glPushAttrib(GL_CURRENT_BIT | GL_LIGHTING_BIT);
-    if (((Button*)logic_)->isSelected())
-        glColor4f(0.0, 1.0, 0.0, 1.0);
-    else
-        glColor4f(0.25, 0.0, 0.0, 0.5);
-    glBegin(GL_QUADS);
-    glVertex2f(width_, -height_);
-    glVertex2f(-width_, -height_);
-    glVertex2f(-width_, height_);
-    glVertex2f(width_, height_);
-    glEnd();
-    glPopAttrib();
+    const GLfloat selected[] = { 0.0, 1.0, 0.0, 1.0 },
+            unselected[] = { 0.25, 0.0, 0.0, 0.5 };
+    DrawBatch* batch = Screen::getInstance()->getBatch();
+    batch->setTexture(0, false);
+    batch->addRectangle(state, ((Button*)logic_)->isSelected() ? selected :
+            unselected, width_, height_);
 }
 
 SubmenuGraphic::SubmenuGraphic(Submenu* submenu) :
@@ -555,7 +518,7 @@ MenuGraphic::~MenuGraphic() {
             labels_.begin(); i < labels_.end(); delete (*i), ++i);
 }
 
-void MenuGraphic::doDraw() {
+void MenuGraphic::doDraw(const DrawState& state) {
     // Draw the active menu
-    menuGraphics_[menu_->getActiveMenu()]->draw();
+    menuGraphics_[menu_->getActiveMenu()]->draw(state);
 }
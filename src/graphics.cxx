@@ -18,40 +18,70 @@
  * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <math.h>
+#include "game_graphics_gl.hxx"
 #include "graphics.hxx"
 
-GraphicModifier::~GraphicModifier() {
+void DrawState::reset() {
+    const float identity[] = { 1, 0, 0, 1, 0, 0 };
+    for (int i = 0; i < 6; ++i)
+        m[i] = identity[i];
+    for (int i = 0; i < 4; ++i)
+        colour[i] = 1;
 }
 
-Graphic::Graphic() :
-        modifiers_() {
+void DrawState::transform(const float* t) {
+    float n[6] = { m[0] * t[0] + m[2] * t[1], m[1] * t[0] + m[3] * t[1],
+            m[0] * t[2] + m[2] * t[3], m[1] * t[2] + m[3] * t[3],
+            m[0] * t[4] + m[2] * t[5] + m[4],
+            m[1] * t[4] + m[3] * t[5] + m[5] };
+    for (int i = 0; i < 6; ++i)
+        m[i] = n[i];
 }
 
-Graphic::~Graphic() {
+void DrawState::translate(float x, float y) {
+    m[4] += m[0] * x + m[2] * y;
+    m[5] += m[1] * x + m[3] * y;
 }
 
-void Graphic::draw() {
-    beginModifiers();
-    doDraw();
-    endModifiers();
+void DrawState::scale(float x, float y) {
+    m[0] *= x;
+    m[1] *= x;
+    m[2] *= y;
+    m[3] *= y;
 }
 
-void Graphic::addModifier(GraphicModifier* modifier) {
-    modifiers_.push_back(modifier);
+void DrawState::rotate(float degrees) {
+    float a = degrees * PI / 180, c = cosf(a), s = sinf(a);
+    float t[] = { c, s, -s, c, 0, 0 };
+    transform(t);
+}
+
+void DrawState::map(float x, float y, float* out) const {
+    out[0] = m[0] * x + m[2] * y + m[4];
+    out[1] = m[1] * x + m[3] * y + m[5];
+}
+
+GraphicModifier::~GraphicModifier() {
+}
+
+Graphic::Graphic() :
+        modifiers_() {
 }
 
-void Graphic::beginModifiers() {
-    // Iterate modifiers in reverse so that the last added modifier is the
+Graphic::~Graphic() {
+}
+
+void Graphic::draw(const DrawState& parent) {
+    // Apply the modifiers in reverse so that the last added modifier is the
     // outermost modifier.
+    DrawState state = parent;
     std::vector<GraphicModifier*>::reverse_iterator i;
     for (i = modifiers_.rbegin(); i < modifiers_.rend(); ++i)
-        (*i)->begin();
+        (*i)->modify(state);
+    doDraw(state);
 }
 
-void Graphic::endModifiers() {
-    // Iterate modifiers in the list order so that they are removed in the
-    // reverse of the order they were applied.
-    std::vector<GraphicModifier*>::iterator i;
-    for (i = modifiers_.begin(); i < modifiers_.end(); ++i)
-        (*i)->end();
+void Graphic::addModifier(GraphicModifier* modifier) {
+    modifiers_.push_back(modifier);
 }
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include "game_physics.hxx"
+#include "gravity_tree.hxx"
+
+const phys_t GravityTree::_THETA = 0.5;
+
+/** Whether a body lies below a value along an axis. */
+struct Below {
+    int axis;
+    phys_t value;
+    bool operator()(AstroBody* b) const {
+        return b->getPosition()[axis] < value;
+    }
+};
+
+GravityTree::GravityTree() :
+        bodies_(),
+        nodes_() {
+}
+
+void GravityTree::build(const std::vector<AstroBody*>& bodies) {
+    bodies_ = bodies;
+    nodes_.clear();
+    if (bodies_.empty())
+        return;
+    vector2p lo = bodies_[0]->getPosition(), hi = lo;
+    for (std::vector<AstroBody*>::iterator i = bodies_.begin();
+            i != bodies_.end(); ++i) {
+        vector2p p = (*i)->getPosition();
+        lo(min(lo.x, p.x), min(lo.y, p.y));
+        hi(max(hi.x, p.x), max(hi.y, p.y));
+    }
+    build(0, bodies_.size(), (lo + hi) * 0.5,
+            max(hi.x - lo.x, hi.y - lo.y) * 0.5, 0);
+}
+
+int GravityTree::build(int first, int last, vector2p centre, phys_t half,
+        int depth) {
+    int k = nodes_.size();
+    nodes_.push_back(Node());
+    Node n;
+    n.size = half * 2;
+    n.first = first;
+    n.last = last;
+    n.gm = 0;
+    n.centre(0, 0);
+    for (int i = first; i < last; ++i) {
+        n.gm += bodies_[i]->gm;
+        n.centre += bodies_[i]->getPosition() * bodies_[i]->gm;
+    }
+    n.centre /= n.gm;
+    n.reach = 0;
+    for (int i = first; i < last; ++i) {
+        n.reach = max(n.reach, (bodies_[i]->getPosition() -
+                n.centre).length() + bodies_[i]->getShape()->
+                getBoundingRadius());
+    }
+    for (int q = 0; q < 4; ++q)
+        n.child[q] = 0;
+    if (last - first > 1 && depth < _MAX_DEPTH) {
+        // Sort the bodies into quadrants: below in y first, then in x.
+        Below by = { 1, centre.y };
+        int mid = std::partition(&bodies_[0] + first, &bodies_[0] + last,
+                by) - &bodies_[0];
+        int bounds[5] = { first, 0, mid, 0, last };
+        for (int h = 0; h < 2; ++h) {
+            Below bx = { 0, centre.x };
+            bounds[h * 2 + 1] = std::partition(&bodies_[0] + bounds[h * 2],
+                    &bodies_[0] + bounds[h * 2 + 2], bx) - &bodies_[0];
+        }
+        phys_t quarter = half * 0.5;
+        for (int q = 0; q < 4; ++q) {
+            if (bounds[q] == bounds[q + 1])
+                continue;
+            vector2p c = centre + vector2p()(q & 1 ? quarter : -quarter,
+                    q & 2 ? quarter : -quarter);
+            n.child[q] = build(bounds[q], bounds[q + 1], c, quarter,
+                    depth + 1);
+        }
+    }
+    nodes_[k] = n;
+    return k;
+}
+
+vector2p GravityTree::getAcceleration(vector2p p) const {
+    vector2p a = { 0, 0 };
+    if (!nodes_.empty())
+        accumulate(0, p, a);
+    return a;
+}
+
+AstroBody* GravityTree::getStrongest(vector2p p) const {
+    AstroBody* best = NULL;
+    phys_t pull = 0;
+    if (!nodes_.empty())
+        findStrongest(0, p, best, pull);
+    return best;
+}
+
+void GravityTree::getNear(vector2p p, phys_t r,
+        std::vector<AstroBody*>& near) const {
+    if (!nodes_.empty())
+        findNear(0, p, r, near);
+}
+
+void GravityTree::accumulate(int k, vector2p p, vector2p& a) const {
+    const Node& n = nodes_[k];
+    bool leaf = true;
+    for (int q = 0; q < 4; ++q)
+        leaf = leaf && !n.child[q];
+    if (leaf) {
+        for (int i = n.first; i < n.last; ++i) {
+            vector2p d = bodies_[i]->getPosition() - p;
+            phys_t dd = d.squared();
+            a += d * (bodies_[i]->gm / (sqrt<phys_t> (dd) * dd));
+        }
+        return;
+    }
+    // Far enough away, and outside every body, the node is a point mass.
+    vector2p d = n.centre - p;
+    phys_t dd = d.squared();
+    if (n.size * n.size < _THETA * _THETA * dd && n.reach * n.reach < dd) {
+        a += d * (n.gm / (sqrt<phys_t> (dd) * dd));
+        return;
+    }
+    for (int q = 0; q < 4; ++q) {
+        if (n.child[q])
+            accumulate(n.child[q], p, a);
+    }
+}
+
+void GravityTree::findStrongest(int k, vector2p p, AstroBody*& best,
+        phys_t& pull) const {
+    const Node& n = nodes_[k];
+    // No body in the node is nearer than its reach allows.
+    phys_t gap = (n.centre - p).length() - n.reach;
+    if (best && gap > 0 && n.gm <= pull * gap * gap)
+        return;
+    bool leaf = true;
+    for (int q = 0; q < 4; ++q) {
+        if (n.child[q]) {
+            leaf = false;
+            findStrongest(n.child[q], p, best, pull);
+        }
+    }
+    if (!leaf)
+        return;
+    for (int i = n.first; i < n.last; ++i) {
+        phys_t g = bodies_[i]->gm / (bodies_[i]->getPosition() -
+                p).squared();
+        if (!best || g > pull) {
+            best = bodies_[i];
+            pull = g;
+        }
+    }
+}
+
+void GravityTree::findNear(int k, vector2p p, phys_t r,
+        std::vector<AstroBody*>& near) const {
+    const Node& n = nodes_[k];
+    phys_t reach = n.reach + r;
+    if ((n.centre - p).squared() > reach * reach)
+        return;
+    bool leaf = true;
+    for (int q = 0; q < 4; ++q) {
+        if (n.child[q]) {
+            leaf = false;
+            findNear(n.child[q], p, r, near);
+        }
+    }
+    if (!leaf)
+        return;
+    for (int i = n.first; i < n.last; ++i) {
+        phys_t rr = bodies_[i]->getShape()->getBoundingRadius() + r;
+        if ((bodies_[i]->getPosition() - p).squared() < rr * rr)
+            near.push_back(bodies_[i]);
+    }
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "handle_table.hxx"
+#include "snapshot.hxx"
+
+HandleTable::HandleTable() :
+        slots_(),
+        owners_(),
+        free_() {
+}
+
+Handle HandleTable::add() {
+    int s;
+    if (free_.empty()) {
+        s = slots_.size();
+        Slot slot = { 0, 1 };
+        slots_.push_back(slot);
+    }
+    else {
+        s = free_.back();
+        free_.pop_back();
+    }
+    slots_[s].index = owners_.size();
+    owners_.push_back(s);
+    Handle h = { s, slots_[s].generation };
+    return h;
+}
+
+int HandleTable::find(Handle h) const {
+    if (h.slot < 0 || h.slot >= (int) slots_.size())
+        return -1;
+    const Slot& s = slots_[h.slot];
+    return s.generation == h.generation ? s.index : -1;
+}
+
+int HandleTable::remove(Handle h) {
+    int i = find(h);
+    if (i < 0)
+        return -1;
+    // Move the last element's slot into the hole.
+    owners_[i] = owners_.back();
+    slots_[owners_[i]].index = i;
+    owners_.pop_back();
+    ++slots_[h.slot].generation;
+    free_.push_back(h.slot);
+    return i;
+}
+
+int HandleTable::size() const {
+    return owners_.size();
+}
+
+void HandleTable::reserve(int n) {
+    slots_.reserve(n);
+    owners_.reserve(n);
+    free_.reserve(n);
+}
+
+void HandleTable::save(Snapshot& s) {
+    s.write(slots_);
+    s.write(owners_);
+    s.write(free_);
+}
+
+void HandleTable::restore(Snapshot& s) {
+    s.read(slots_);
+    s.read(owners_);
+    s.read(free_);
+}
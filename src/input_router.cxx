@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "input_router.hxx"
+#include "player.hxx"
+
+InputRouter::InputRouter() :
+        table_() {
+}
+
+bool InputRouter::handle(const SDL_Event& event) {
+    double value;
+    int i;
+    switch (event.type) {
+    case SDL_KEYUP:
+    case SDL_KEYDOWN:
+        value = event.key.state == SDL_PRESSED ? 1.0 : 0.0;
+        i = getIndex(KEY, 0, event.key.keysym.sym);
+        break;
+    case SDL_JOYBUTTONUP:
+    case SDL_JOYBUTTONDOWN:
+        value = event.jbutton.state == SDL_PRESSED ? 1.0 : 0.0;
+        i = getIndex(JOY_BUTTON, event.jbutton.which, event.jbutton.button);
+        break;
+    case SDL_JOYAXISMOTION:
+        value = event.jaxis.value / 32768.0;
+        i = getIndex(JOY_AXIS, event.jaxis.which, event.jaxis.axis);
+        break;
+    default:
+        return false;
+    }
+    if (i < 0 || i >= (int) table_.size() || !table_[i].player)
+        return false;
+    return table_[i].player->input(table_[i].action, value);
+}
+
+void InputRouter::bind(InputKind kind, int device, int code, Player* player,
+        ActionType action) {
+    int i = getIndex(kind, device, code);
+    if (i < 0)
+        return;
+    if (i >= (int) table_.size()) {
+        Target none = { NULL, NOTHING };
+        table_.resize(i + 1, none);
+    }
+    table_[i].player = action == NOTHING ? NULL : player;
+    table_[i].action = action;
+}
+
+void InputRouter::unbind(Player* player) {
+    for (std::vector<Target>::iterator i = table_.begin(); i != table_.end();
+            ++i) {
+        if (i->player == player) {
+            i->player = NULL;
+            i->action = NOTHING;
+        }
+    }
+}
+
+void InputRouter::clear() {
+    table_.clear();
+}
+
+int InputRouter::getIndex(InputKind kind, int device, int code) {
+    switch (kind) {
+    case KEY:
+        return code >= 0 && code < SDLK_LAST ? code : -1;
+    case JOY_BUTTON:
+    case JOY_AXIS:
+        if (device < 0 || device > 255 || code < 0 || code >= _JOY_CODES)
+            return -1;
+        return SDLK_LAST + (device * 2 + (kind == JOY_AXIS)) * _JOY_CODES +
+                code;
+    default:
+        return -1;
+    }
+}
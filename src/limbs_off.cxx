@@ -22,10 +22,57 @@
 #include <config.h>
 #endif
 
+#include <stdlib.h>
+#include <unistd.h>
 #include "game_graphics_gl.hxx"
 #include "game_loop.hxx"
 
 int main(int argc, char *argv[]) {
+    NetConfig net;
+    net.port = 0;
+    net.localPlayer = 0;
+    net.delay = 2;
+    net.loopbackLatency = -1;
+    net.loopbackLoss = 0.0;
+    bool networked = false;
+    const char* stream = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "p:c:s:n:d:L:x:o:")) != -1) {
+        networked = networked || opt != 'o';
+        switch (opt) {
+        case 'p':
+            net.port = atoi(optarg);
+            break;
+        case 'c':
+            net.peers.push_back(optarg);
+            break;
+        case 's':
+            net.server = optarg;
+            break;
+        case 'n':
+            net.localPlayer = max(atoi(optarg) - 1, 0);
+            break;
+        case 'd':
+            net.delay = atoi(optarg);
+            break;
+        case 'L':
+            net.loopbackLatency = max(atoi(optarg), 0);
+            break;
+        case 'x':
+            net.loopbackLoss = atof(optarg) / 100.0;
+            break;
+        case 'o':
+            stream = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-p port] [-c host:port]... "
+                    "[-s host:port] [-n player] [-d delay]\n"
+                    "       [-L loopback latency] [-x loopback loss %%] "
+                    "[-o stream socket]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
 #if VERBOSE
     printf("LIMBS OFF - verbose version\n\n"
             "feel free to explore our little world.\n"
@@ -43,6 +90,10 @@ int main(int argc, char *argv[]) {
 #endif
     Screen::setVideoMode(1024, 768, 32);
     GameLoop loop;
+    if (networked)
+        loop.setNetwork(net);
+    if (stream && !loop.setStream(stream))
+        printf("ERROR: Could not open the stream at %s.\n", stream);
     int code = loop.run();
 #if VERBOSE
     printf("thank you for playing LIMBS OFF.\n");
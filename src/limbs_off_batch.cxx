@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Batch match runner. Plays many headless matches at once, one on each
+ * processor, for balance tuning and for soak-testing the physics. Every
+ * match is seeded, so any line of the output can be played again alone:
+ *
+ *     ./limbs-off-batch -m 1000 -M limbs=40000,1.2 > limbs.csv
+ *     ./limbs-off-batch -m 1 -r 1234
+ *
+ * Each match is a line of CSV on standard output, and the totals go to
+ * standard error.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include <SDL/SDL.h>
+#include "game.hxx"
+
+/** Steps per second, as in GameLoop. */
+static const double STEPS_PER_SECOND = 150;
+/** Steps between each scripted input. */
+static const int INPUT_INTERVAL = 15;
+/** Distance to an opponent within which the chasing script punches. */
+static const phys_t REACH = 1.2;
+/** Names of the materials, in the order of Game::MaterialType. */
+static const char* MATERIAL_NAMES[] = { "body", "head", "limbs",
+        "limbs-off", "planet" };
+
+/** How the characters are played. */
+enum Script {
+    /** Press and release random actions. */
+    RANDOM,
+    /** Walk to the nearest opponent and punch it. */
+    CHASE
+};
+
+struct Settings {
+    int matches, steps, characters, threads;
+    unsigned int seed;
+    Script script;
+    /** Material overrides, or negative stiffness for none. */
+    double stiffness[Game::NUM_MATERIAL], toughness[Game::NUM_MATERIAL];
+};
+
+struct Result {
+    unsigned int seed;
+    /** Steps until at most one character was left alive, or all steps. */
+    int length;
+    int survivors;
+    /** Mean mass of the characters at the end. */
+    double mass;
+    long collisions;
+    double maxImpulse;
+    /** Processor seconds spent simulating. */
+    double seconds;
+};
+
+/** Matches shared out among the threads. */
+struct Batch {
+    const Settings* settings;
+    SDL_mutex* mutex;
+    int next;
+    std::vector<Result> results;
+};
+
+/** Deterministic pseudo-random numbers, independent of the C library. */
+static unsigned int nextRandom(unsigned int& seed) {
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 16;
+}
+
+static double getTime(clockid_t clock) {
+    timespec t;
+    clock_gettime(clock, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void playRandom(Game& game, int i, unsigned int& seed) {
+    const ActionType actions[] = { LEFT, RIGHT, JUMP, CROUCH, LPUNCH,
+            RPUNCH };
+    unsigned int r = nextRandom(seed);
+    game.getPlayer(i)->act(actions[(r >> 1) % 6], r & 1);
+}
+
+static void playChase(Game& game, int i, unsigned int& seed) {
+    Character* self = game.getCharacter(i);
+    vector2p centre = game.getPlanet(0)->getPosition(),
+            p = self->getState().p;
+    int target = -1;
+    phys_t nearest = 0;
+    for (int j = 0; j < game.getNumPlayers(); ++j) {
+        Character* c = game.getCharacter(j);
+        phys_t d = (c->getState().p - p).length();
+        if (j != i && !c->isDead() && (target < 0 || d < nearest)) {
+            target = j;
+            nearest = d;
+        }
+    }
+    Player* player = game.getPlayer(i);
+    if (target < 0)
+        return;
+    // Walking left goes anticlockwise round the planet.
+    vector2p q = game.getCharacter(target)->getState().p - centre;
+    bool left = (p - centre) / q > 0;
+    unsigned int r = nextRandom(seed);
+    if (nearest > REACH) {
+        player->act(left ? LEFT : RIGHT, 1.0);
+        player->act(JUMP, r % 6 == 0);
+        return;
+    }
+    // Stop facing the target, and punch with alternate hands.
+    player->act(left ? RIGHT : LEFT, 0.0);
+    player->act(left ? LEFT : RIGHT, 0.0);
+    bool front = r & 1;
+    player->act(LPUNCH, front);
+    player->act(RPUNCH, !front);
+}
+
+static Result playMatch(const Settings& s, unsigned int seed) {
+    Result result = { seed, s.steps, 0, 0.0, 0, 0.0, 0.0 };
+    double start = getTime(CLOCK_THREAD_CPUTIME_ID);
+    Game game(NULL, s.characters, 0);
+    for (int m = 0; m < Game::NUM_MATERIAL; ++m) {
+        if (s.stiffness[m] >= 0)
+            *game.getMaterial((Game::MaterialType) m) = Material(
+                    s.stiffness[m], s.toughness[m]);
+    }
+    for (int step = 1; step <= s.steps; ++step) {
+        if (step % INPUT_INTERVAL == 0) {
+            for (int i = 0; i < s.characters; ++i) {
+                if (s.script == CHASE)
+                    playChase(game, i, seed);
+                else
+                    playRandom(game, i, seed);
+            }
+        }
+        game.update(1.0 / STEPS_PER_SECOND);
+        const std::vector<CollisionEvent>& collisions =
+                game.getUniverse()->getCollisions();
+        result.collisions += collisions.size();
+        for (std::vector<CollisionEvent>::const_iterator i =
+                collisions.begin(); i != collisions.end(); ++i)
+            result.maxImpulse = max<double>(result.maxImpulse, i->impulse);
+        int alive = 0;
+        for (int i = 0; i < s.characters; ++i)
+            alive += !game.getCharacter(i)->isDead();
+        if (alive <= 1 && result.length == s.steps)
+            result.length = step;
+        result.survivors = alive;
+    }
+    for (int i = 0; i < s.characters; ++i)
+        result.mass += game.getCharacter(i)->getMass() / s.characters;
+    result.seconds = getTime(CLOCK_THREAD_CPUTIME_ID) - start;
+    return result;
+}
+
+static int work(void* data) {
+    Batch* batch = (Batch*) data;
+    const Settings& s = *batch->settings;
+    for (;;) {
+        SDL_mutexP(batch->mutex);
+        int match = batch->next++;
+        SDL_mutexV(batch->mutex);
+        if (match >= s.matches)
+            return 0;
+        // Each match has its own slot, so no lock is needed to fill it.
+        batch->results[match] = playMatch(s, s.seed + match);
+    }
+}
+
+/** Parse name=stiffness,toughness. Returns false if it is not one. */
+static bool parseMaterial(const char* arg, Settings& s) {
+    char name[16];
+    double stiffness, toughness;
+    if (sscanf(arg, "%15[^=]=%lf,%lf", name, &stiffness, &toughness) != 3 ||
+            stiffness < 0 || toughness <= 0)
+        return false;
+    for (int m = 0; m < Game::NUM_MATERIAL; ++m) {
+        if (!strcmp(name, MATERIAL_NAMES[m])) {
+            s.stiffness[m] = stiffness;
+            s.toughness[m] = toughness;
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char* argv[]) {
+    Settings s;
+    s.matches = 1000;
+    s.steps = 60 * STEPS_PER_SECOND;
+    s.characters = 4;
+    s.threads = max((int) sysconf(_SC_NPROCESSORS_ONLN), 1);
+    s.seed = 1;
+    s.script = CHASE;
+    for (int m = 0; m < Game::NUM_MATERIAL; ++m)
+        s.stiffness[m] = s.toughness[m] = -1;
+    int opt;
+    bool ok = true;
+    while ((opt = getopt(argc, argv, "m:s:n:j:r:xM:")) != -1) {
+        switch (opt) {
+        case 'm':
+            s.matches = max(atoi(optarg), 0);
+            break;
+        case 's':
+            s.steps = max(atoi(optarg), 1);
+            break;
+        case 'n':
+            s.characters = min(max(atoi(optarg), 1), 16);
+            break;
+        case 'j':
+            s.threads = max(atoi(optarg), 1);
+            break;
+        case 'r':
+            s.seed = strtoul(optarg, NULL, 10);
+            break;
+        case 'x':
+            s.script = RANDOM;
+            break;
+        case 'M':
+            ok = ok && parseMaterial(optarg, s);
+            break;
+        default:
+            ok = false;
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "usage: %s [-m matches] [-s steps] [-n characters] "
+                "[-j threads] [-r seed] [-x random input]\n"
+                "\t[-M material=stiffness,toughness]...\n"
+                "materials: body, head, limbs, limbs-off, planet\n", argv[0]);
+        return 1;
+    }
+    Batch batch;
+    batch.settings = &s;
+    batch.mutex = SDL_CreateMutex();
+    batch.next = 0;
+    batch.results.resize(s.matches);
+    s.threads = min(s.threads, max(s.matches, 1));
+    double start = getTime(CLOCK_MONOTONIC);
+    std::vector<SDL_Thread*> threads;
+    for (int i = 0; i < s.threads; ++i)
+        threads.push_back(SDL_CreateThread(work, &batch));
+    for (std::vector<SDL_Thread*>::iterator i = threads.begin();
+            i != threads.end(); ++i)
+        SDL_WaitThread(*i, NULL);
+    double elapsed = getTime(CLOCK_MONOTONIC) - start;
+    SDL_DestroyMutex(batch.mutex);
+    // Settings as comments, then a line per match.
+    printf("# %d-bit physics, %d characters, %d steps, %s input\n",
+            (int) sizeof(phys_t) * 8, s.characters, s.steps,
+            s.script == CHASE ? "chasing" : "random");
+    for (int m = 0; m < Game::NUM_MATERIAL; ++m) {
+        if (s.stiffness[m] >= 0)
+            printf("# %s stiffness %g, toughness %g\n", MATERIAL_NAMES[m],
+                    s.stiffness[m], s.toughness[m]);
+    }
+    printf("seed,length,survivors,mass,collisions,max_impulse,seconds,"
+            "steps_per_second\n");
+    double seconds = 0, length = 0, survivors = 0, mass = 0, collisions = 0;
+    for (std::vector<Result>::iterator i = batch.results.begin();
+            i != batch.results.end(); ++i) {
+        printf("%u,%d,%d,%.4g,%ld,%.4g,%.4g,%.0f\n", i->seed, i->length,
+                i->survivors, i->mass, i->collisions, i->maxImpulse,
+                i->seconds, s.steps / max(i->seconds, 1e-9));
+        seconds += i->seconds;
+        length += i->length;
+        survivors += i->survivors;
+        mass += i->mass;
+        collisions += i->collisions;
+    }
+    double steps = (double) s.steps * s.matches, n = max(s.matches, 1);
+    fprintf(stderr, "%d matches on %d threads in %.1f s: %.0f steps/s, "
+            "%.0f steps/s per thread\n"
+            "mean length %.0f steps, %.2f survivors, %.1f mass, "
+            "%.0f collisions\n", s.matches, s.threads, elapsed,
+            steps / max(elapsed, 1e-9), steps / max(seconds, 1e-9),
+            length / n, survivors / n, mass / n, collisions / n);
+    return 0;
+}
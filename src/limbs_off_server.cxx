@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Headless server. Runs a game with no screen, taking the players' inputs
+ * from clients and sending them the game at a fixed tick rate:
+ *
+ *     limbs-off-server -p 4000 -n 4
+ *     limbs-off -s serverhost:4000
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <SDL/SDL.h>
+#include "game_loop.hxx"
+#include "game_server.hxx"
+#include "repeat.hxx"
+#include "state_stream.hxx"
+#include "step_timer.hxx"
+
+int main(int argc, char* argv[]) {
+    int port = 4000, numPlayers = 2, opt;
+    double tickRate = 30, statsInterval = 5;
+    const char* streamPath = NULL;
+    while ((opt = getopt(argc, argv, "p:n:r:s:o:")) != -1) {
+        switch (opt) {
+        case 'p':
+            port = atoi(optarg);
+            break;
+        case 'n':
+            numPlayers = max(atoi(optarg), 1);
+            break;
+        case 'r':
+            tickRate = atof(optarg);
+            break;
+        case 's':
+            statsInterval = atof(optarg);
+            break;
+        case 'o':
+            streamPath = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-p port] [-n players] "
+                    "[-r tick rate] [-s stats interval]\n"
+                    "       [-o stream socket]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (tickRate <= 0 || SDL_Init(SDL_INIT_TIMER) < 0) {
+        fprintf(stderr, "ERROR: Could not start the server.\n");
+        return 1;
+    }
+    Game game(NULL, numPlayers, 0);
+    GameServer server(&game, GameLoop::_STEPS_PER_SECOND / tickRate + 0.5);
+    if (!server.open(port)) {
+        fprintf(stderr, "ERROR: Could not listen on port %d.\n", port);
+        SDL_Quit();
+        return 1;
+    }
+    StateStream stream;
+    if (streamPath && !stream.open(streamPath))
+        printf("ERROR: Could not open the stream at %s.\n", streamPath);
+    printf("serving %d players on port %d at %g ticks per second.\n",
+            numPlayers, port, tickRate);
+    StepTimer timer;
+    Uint32 time = SDL_GetTicks(), statsTime = time;
+    for (;;) {
+        int steps = timer.getStepTime() * GameLoop::_STEPS_PER_SECOND;
+        timer.time(steps / GameLoop::_STEPS_PER_SECOND);
+        REPEAT(steps, I) {
+            server.update(1.0 / GameLoop::_STEPS_PER_SECOND);
+            stream.collect(&game);
+        }
+        stream.publish(&game);
+        SDL_Delay(1000 / GameLoop::_STEPS_PER_SECOND);
+        Uint32 delta = SDL_GetTicks() - time;
+        time += delta;
+        timer.targetTime(delta / 1000.0);
+        if (statsInterval <= 0 || time - statsTime < statsInterval * 1000)
+            continue;
+        printf("%d clients, %.0f bytes per client per tick, "
+                "%.3f ms of CPU per tick\n", server.getNumClients(),
+                server.getBytesPerClient(), server.getTickTime() * 1000);
+        fflush(stdout);
+        server.resetStats();
+        statsTime = time;
+    }
+    return 0;
+}
@@ -0,0 +1,305 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "net_session.hxx"
+
+/** Packet tag and version. */
+static const unsigned char MAGIC[] = { 'L', 'O', 1 };
+/** Size of the packet header, and of one input. */
+static const int HEADER_SIZE = 12, INPUT_SIZE = 4;
+/** Max inputs in one packet. */
+static const int MAX_INPUTS = 64;
+
+/**
+ * Pack the sender's player, the steps of input it has from the receiver,
+ * and count inputs starting at step first.
+ */
+static int pack(unsigned char* p, int player, int ack, int first,
+        const StepInput* inputs, int count) {
+    memcpy(p, MAGIC, sizeof(MAGIC));
+    p[3] = player;
+    UdpSocket::putU32(p + 4, ack);
+    UdpSocket::putU32(p + 8, first);
+    unsigned char* q = p + HEADER_SIZE;
+    *q++ = count;
+    for (int i = 0; i < count; ++i, q += INPUT_SIZE) {
+        q[0] = inputs[i].held & 0xff;
+        q[1] = inputs[i].held >> 8;
+        q[2] = inputs[i].left;
+        q[3] = inputs[i].right;
+    }
+    return q - p;
+}
+
+/** Unpack a packet. Returns the number of inputs, or -1 if malformed. */
+static int unpack(const unsigned char* p, int size, int& player, int& ack,
+        int& first, StepInput* inputs) {
+    if (size < HEADER_SIZE + 1 || memcmp(p, MAGIC, sizeof(MAGIC)))
+        return -1;
+    player = p[3];
+    ack = UdpSocket::getU32(p + 4);
+    first = UdpSocket::getU32(p + 8);
+    const unsigned char* q = p + HEADER_SIZE;
+    int count = *q++;
+    if (count > MAX_INPUTS || size != HEADER_SIZE + 1 + count * INPUT_SIZE)
+        return -1;
+    for (int i = 0; i < count; ++i, q += INPUT_SIZE) {
+        inputs[i].held = q[0] | q[1] << 8;
+        inputs[i].left = q[2];
+        inputs[i].right = q[3];
+    }
+    return count;
+}
+
+LoopbackPeer::LoopbackPeer(int player, int latency, double loss) :
+        socket_(),
+        player_(player),
+        latency_(latency),
+        loss_(loss),
+        frame_(0),
+        acked_(0),
+        received_(0),
+        seed_(player + 1),
+        inputs_(),
+        queue_() {
+}
+
+bool LoopbackPeer::open(unsigned short sessionPort) {
+    session_ = UdpSocket::getLocalAddress(sessionPort);
+    return socket_.open(0);
+}
+
+unsigned short LoopbackPeer::getPort() {
+    return socket_.getPort();
+}
+
+void LoopbackPeer::update() {
+    unsigned char buffer[HEADER_SIZE + 1 + MAX_INPUTS * INPUT_SIZE];
+    StepInput inputs[MAX_INPUTS];
+    int n, player, ack, first;
+    while ((n = socket_.receive(buffer, sizeof(buffer), NULL)) >= 0) {
+        int count = unpack(buffer, n, player, ack, first, inputs);
+        if (count < 0)
+            continue;
+        acked_ = max(acked_, min(ack, frame_));
+        if (first <= received_)
+            received_ = max(received_, first + count);
+    }
+    // Like a real peer, wait for the session rather than run away.
+    if (frame_ - acked_ < NetSession::_MAX_ROLLBACK &&
+            frame_ - received_ < NetSession::_MAX_ROLLBACK) {
+        StepInput input = { 0, 0, 0 };
+        if (!inputs_.empty())
+            input = inputs_.back();
+        seed_ = seed_ * 1103515245u + 12345u;
+        unsigned int r = seed_ >> 16;
+        if (r % 20 == 0) {
+            static const ActionType ACTIONS[] = { LEFT, RIGHT, JUMP, CROUCH,
+                    LPUNCH, RPUNCH };
+            input.set(ACTIONS[r / 20 % 6], r / 120 % 2);
+        }
+        inputs_.push_back(input);
+        ++frame_;
+    }
+    int count = min(frame_ - acked_, MAX_INPUTS);
+    Delayed d;
+    d.due = frame_ + latency_;
+    d.data.resize(HEADER_SIZE + 1 + count * INPUT_SIZE);
+    pack(&d.data[0], player_, received_, acked_, &inputs_[0] + acked_,
+            count);
+    if (rand() >= loss_ * RAND_MAX)
+        queue_.push_back(d);
+    while (!queue_.empty() && queue_[0].due <= frame_) {
+        socket_.send(&queue_[0].data[0], queue_[0].data.size(), session_);
+        queue_.erase(queue_.begin());
+    }
+}
+
+NetSession::NetSession(Game* game, int localPlayer, int delay) :
+        game_(game),
+        local_(localPlayer),
+        delay_(min(max(delay, 0), _MAX_DELAY)),
+        socket_(),
+        peers_(),
+        loopback_(NULL),
+        frame_(0),
+        inputs_(game->getNumPlayers() * _HISTORY),
+        confirmed_(game->getNumPlayers(), 0),
+        rollbackFrom_(0),
+        resimulated_(0) {
+    StepInput none = { 0, 0, 0 };
+    capture_ = none;
+    for (std::vector<StepInput>::iterator i = inputs_.begin();
+            i != inputs_.end(); ++i)
+        *i = none;
+    // The first steps, before any input can arrive, are empty.
+    confirmed_[local_] = delay_;
+    game_->setLocalPlayer(local_);
+    game_->getPlayer(local_)->setCapture(&capture_);
+}
+
+NetSession::~NetSession() {
+    game_->getPlayer(local_)->setCapture(NULL);
+    delete loopback_;
+}
+
+bool NetSession::open(unsigned short port) {
+    return socket_.open(port);
+}
+
+bool NetSession::addPeer(const char* address) {
+    Peer p;
+    if (!UdpSocket::resolve(address, p.address))
+        return false;
+    p.player = -1;
+    p.acked = 0;
+    peers_.push_back(p);
+    return true;
+}
+
+bool NetSession::addLoopbackPeer(int player, int latency, double loss) {
+    if (loopback_ || !socket_.isOpen())
+        return false;
+    loopback_ = new LoopbackPeer(player, latency, loss);
+    if (!loopback_->open(socket_.getPort())) {
+        delete loopback_;
+        loopback_ = NULL;
+        return false;
+    }
+    Peer p;
+    p.address = UdpSocket::getLocalAddress(loopback_->getPort());
+    p.player = player;
+    p.acked = 0;
+    peers_.push_back(p);
+    return true;
+}
+
+bool NetSession::update(phys_t dt) {
+    if (loopback_)
+        loopback_->update();
+    receive();
+    // Wait rather than run further ahead of a peer than can be rolled back.
+    bool wait = false;
+    for (int p = 0; p < (int) confirmed_.size(); ++p)
+        wait = wait || (p != local_ && frame_ - confirmed_[p] >=
+                _MAX_ROLLBACK);
+    for (std::vector<Peer>::iterator i = peers_.begin(); i != peers_.end();
+            ++i)
+        wait = wait || confirmed_[local_] - i->acked >= _MAX_ROLLBACK;
+    if (wait) {
+        send();
+        return false;
+    }
+    at(local_, frame_ + delay_) = capture_;
+    confirmed_[local_] = frame_ + delay_ + 1;
+    send();
+    if (rollbackFrom_ < frame_) {
+        game_->restore(snapshots_[rollbackFrom_ % _HISTORY], false);
+        for (int f = rollbackFrom_; f < frame_; ++f)
+            simulate(f, dt);
+        resimulated_ += frame_ - rollbackFrom_;
+    }
+    simulate(frame_, dt);
+    rollbackFrom_ = ++frame_;
+    game_->updateGraphics();
+    return true;
+}
+
+int NetSession::getResimulated() {
+    return resimulated_;
+}
+
+StepInput& NetSession::at(int player, int frame) {
+    return inputs_[player * _HISTORY + frame % _HISTORY];
+}
+
+void NetSession::receive() {
+    unsigned char buffer[HEADER_SIZE + 1 + MAX_INPUTS * INPUT_SIZE];
+    StepInput inputs[MAX_INPUTS];
+    sockaddr_in from;
+    int n, numPlayers = confirmed_.size();
+    while ((n = socket_.receive(buffer, sizeof(buffer), &from)) >= 0) {
+        int player, ack, first, count;
+        count = unpack(buffer, n, player, ack, first, inputs);
+        if (count < 0 || player == local_ || player >= numPlayers)
+            continue;
+        Peer* peer = NULL;
+        for (std::vector<Peer>::iterator i = peers_.begin();
+                i != peers_.end(); ++i) {
+            if (UdpSocket::isSameAddress(i->address, from))
+                peer = &*i;
+        }
+        if (!peer)
+            continue;
+        peer->player = player;
+        peer->acked = max(peer->acked, min(ack, confirmed_[local_]));
+        // Take the inputs in order, and only as far as the history holds.
+        int f = confirmed_[player];
+        int end = min(first + count, frame_ + _HISTORY - _MAX_ROLLBACK - 1);
+        if (f < first)
+            continue;
+        for (; f < end; ++f) {
+            if (f < frame_ && at(player, f) != inputs[f - first])
+                rollbackFrom_ = min(rollbackFrom_, f);
+            at(player, f) = inputs[f - first];
+        }
+        confirmed_[player] = max(confirmed_[player], f);
+    }
+    // Steps predicted from an older input must be predicted again.
+    for (int p = 0; p < numPlayers; ++p) {
+        if (p == local_ || !confirmed_[p])
+            continue;
+        const StepInput& last = at(p, confirmed_[p] - 1);
+        for (int f = confirmed_[p]; f < rollbackFrom_; ++f) {
+            if (at(p, f) != last)
+                rollbackFrom_ = f;
+        }
+    }
+}
+
+void NetSession::send() {
+    unsigned char buffer[HEADER_SIZE + 1 + MAX_INPUTS * INPUT_SIZE];
+    StepInput inputs[MAX_INPUTS];
+    int end = confirmed_[local_];
+    for (std::vector<Peer>::iterator i = peers_.begin(); i != peers_.end();
+            ++i) {
+        int first = max(i->acked, end - MAX_INPUTS);
+        for (int f = first; f < end; ++f)
+            inputs[f - first] = at(local_, f);
+        int n = pack(buffer, local_, i->player < 0 ? 0 :
+                confirmed_[i->player], first, inputs, end - first);
+        socket_.send(buffer, n, i->address);
+    }
+}
+
+void NetSession::simulate(int frame, phys_t dt) {
+    StepInput none = { 0, 0, 0 };
+    int numPlayers = confirmed_.size();
+    for (int p = 0; p < numPlayers; ++p) {
+        if (frame >= confirmed_[p])
+            at(p, frame) = confirmed_[p] ? at(p, confirmed_[p] - 1) : none;
+    }
+    game_->save(snapshots_[frame % _HISTORY]);
+    for (int p = 0; p < numPlayers; ++p)
+        at(p, frame).apply(game_->getPlayer(p), frame ? at(p, frame - 1) :
+                none);
+    game_->step(dt);
+}
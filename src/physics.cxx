@@ -18,7 +18,12 @@
  * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <math.h>
+#include <limits>
 #include "physics.hxx"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 CollisionQueue::CollisionQueue() :
         collisions_() {
@@ -37,42 +42,435 @@ void CollisionQueue::add(Collision c) {
         other = c.conflicts(*other) ? collisions_.erase(other) : ++other;
 }
 
-bool collideCircleCircle(Circle<phys_t>* ca, Circle<phys_t>* cb, state2p sa,
-        state2p sb, state2p& na, state2p& nb, phys_t& t, vector2p& p,
-        vector2p& n) {
-    phys_t ra = ca->getRadius(), r = ra + cb->getRadius(), rr = r * r;
-    vector2p d1 = sb.p - sa.p, d2 = nb.p - na.p;
-    phys_t t2, rt;
-    if (!intersectLineCircle(d1, d2, rr, t, t2) || t >= 1.0 || t2 < 0.0)
-        return false;
-    t = max<phys_t> (0.0, t);
-    rt = 1 - t;
-    na = sa * rt + na * t;
-    vector2p pa = na.p;
-    nb = sb * rt + nb * t;
-    n = (nb.p - pa) / r;
-    p = n * ra;
-    return true;
-}
-
-bool collide(Body* a, Body* b, bodystate& na, bodystate& nb, phys_t& t,
-        vector2p& p, vector2p& n) {
-    Shape<phys_t> *sa = a->getShape(), *sb = b->getShape();
-    ShapeType ta = sa->getType(), tb = sb->getType();
-    switch (ta) {
-    case CIRCLE:
-        switch (tb) {
-        case CIRCLE:
-            return collideCircleCircle((Circle<phys_t>*) sa,
-                    (Circle<phys_t>*) sb, a->getState(), b->getState(), na.l,
-                    nb.l, t, p, n);
-        default:
-            ;
+/** Position and orientation of a shape at some time during a sweep. */
+struct Pose {
+    vector2p p, r;
+};
+
+/**
+ * Convex core of a shape: a point, segment or polygon, grown by a radius.
+ * Any pair of shapes can be measured through their cores.
+ */
+struct Core {
+    vector2p v[4];
+    int n;
+    phys_t r;
+};
+
+static void getCore(Circle<phys_t>* s, Pose q, Core& c) {
+    c.v[0] = q.p;
+    c.n = 1;
+    c.r = s->getRadius();
+}
+
+static void getCore(Capsule<phys_t>* s, Pose q, Core& c) {
+    vector2p e = q.r * s->getHalfLength();
+    c.v[0] = q.p - e;
+    c.v[1] = q.p + e;
+    c.n = 2;
+    c.r = s->getRadius();
+}
+
+static void getCore(Rectangle<phys_t>* s, Pose q, Core& c) {
+    vector2p x = q.r * s->getHalfWidth(), y = ~q.r * s->getHalfHeight();
+    c.v[0] = q.p - x - y;
+    c.v[1] = q.p + x - y;
+    c.v[2] = q.p + x + y;
+    c.v[3] = q.p - x + y;
+    c.n = 4;
+    c.r = 0.0;
+}
+
+static vector2p closestOnSegment(vector2p a, vector2p b, vector2p p) {
+    vector2p ab = b - a;
+    phys_t dd = ab.squared();
+    if (dd <= 0)
+        return a;
+    return a + ab * max<phys_t> (0.0, min<phys_t> (1.0, (p - a) * ab / dd));
+}
+
+/** Project a core onto an axis. */
+static void project(const Core& c, vector2p axis, phys_t& lo, phys_t& hi) {
+    lo = hi = c.v[0] * axis;
+    for (int i = 1; i < c.n; ++i) {
+        phys_t x = c.v[i] * axis;
+        lo = min<phys_t> (lo, x);
+        hi = max<phys_t> (hi, x);
+    }
+}
+
+/**
+ * Find the deepest overlap of two cores along their edge normals. Returns
+ * the largest gap, which is negative if and only if the cores overlap.
+ */
+static phys_t overlapCores(const Core& a, const Core& b, vector2p& n) {
+    phys_t best = -std::numeric_limits<phys_t>::infinity();
+    const Core* cs[] = { &a, &b };
+    for (int k = 0; k < 2; ++k) {
+        const Core& c = *cs[k];
+        for (int i = 0; i < (c.n == 2 ? 1 : c.n); ++i) {
+            vector2p axis = ~(c.v[(i + 1) % c.n] - c.v[i]);
+            if (c.n < 2 || axis.squared() <= 0)
+                continue;
+            axis.norm();
+            phys_t loA, hiA, loB, hiB;
+            project(a, axis, loA, hiA);
+            project(b, axis, loB, hiB);
+            phys_t gap = max<phys_t> (loB - hiA, loA - hiB);
+            if (gap > best) {
+                best = gap;
+                n = loB - hiA > loA - hiB ? axis : -axis;
+            }
         }
-    default:
-        ;
     }
-    return false;
+    return best;
+}
+
+/**
+ * Measure the distance between two cores. Sets n to the normal from a to
+ * b and w to the witness point on a's core. Overlapping cores give the
+ * negative penetration depth.
+ */
+static phys_t measureCores(const Core& a, const Core& b, vector2p& n,
+        vector2p& w) {
+    phys_t depth = -std::numeric_limits<phys_t>::infinity();
+    vector2p axis;
+    if (a.n > 1 || b.n > 1) {
+        depth = overlapCores(a, b, axis);
+        n = axis;
+        if (depth < 0) {
+            if (a.n == 1) {
+                w = a.v[0];
+                return depth;
+            }
+            // Average b's deepest vertices, moved onto a's face.
+            phys_t lo, hi;
+            project(b, n, lo, hi);
+            phys_t tolerance = 1e-3 * (hi - lo - depth);
+            vector2p sum = { 0.0, 0.0 };
+            int count = 0;
+            for (int i = 0; i < b.n; ++i) {
+                if (b.v[i] * n <= lo + tolerance) {
+                    sum += b.v[i];
+                    ++count;
+                }
+            }
+            w = sum / count - n * depth;
+            return depth;
+        }
+    }
+    phys_t best = std::numeric_limits<phys_t>::infinity();
+    const Core* cs[] = { &a, &b };
+    for (int k = 0; k < 2; ++k) {
+        const Core& c = *cs[k], & o = *cs[1 - k];
+        for (int i = 0; i < c.n; ++i) {
+            for (int j = 0; j < (o.n == 2 ? 1 : o.n); ++j) {
+                vector2p q = closestOnSegment(o.v[j], o.v[(j + 1) % o.n],
+                        c.v[i]);
+                vector2p d = k ? c.v[i] - q : q - c.v[i];
+                phys_t dd = d.squared();
+                if (dd < best) {
+                    best = dd;
+                    n = d;
+                    w = k ? q : c.v[i];
+                }
+            }
+        }
+    }
+    best = sqrt<phys_t> (best);
+    // Where an edge normal separates the cores by the full distance, it is
+    // a better normal than the closest points, which may nearly coincide.
+    phys_t noise = 64 * std::numeric_limits<phys_t>::epsilon() *
+            (abs<phys_t> (a.v[0].x) + abs<phys_t> (a.v[0].y) + 1);
+    if (depth >= best * (1 - 1e-6) - noise)
+        n = axis;
+    else
+        n = best > 0 ? n / best : vector2p()(1.0, 0.0);
+    return best;
+}
+
+/**
+ * Narrow phase for a pair of shapes. Measures the distance between shapes
+ * a and b at the given poses, and sets n to the normal from a to b and w
+ * to the closest point on a's surface. Specialise for faster pairs.
+ */
+template<class A, class B>
+struct Narrow {
+    static phys_t measure(A* a, Pose qa, B* b, Pose qb, vector2p& n,
+            vector2p& w) {
+        Core ca, cb;
+        getCore(a, qa, ca);
+        getCore(b, qb, cb);
+        phys_t d = measureCores(ca, cb, n, w);
+        w += n * ca.r;
+        return d - ca.r - cb.r;
+    }
+};
+
+template<>
+struct Narrow<Capsule<phys_t>, Circle<phys_t> > {
+    static phys_t measure(Capsule<phys_t>* a, Pose qa, Circle<phys_t>* b,
+            Pose qb, vector2p& n, vector2p& w) {
+        vector2p e = qa.r * a->getHalfLength();
+        vector2p q = closestOnSegment(qa.p - e, qa.p + e, qb.p), d = qb.p - q;
+        phys_t l = d.length();
+        n = l > 0 ? d / l : ~qa.r;
+        w = q + n * a->getRadius();
+        return l - a->getRadius() - b->getRadius();
+    }
+};
+
+template<>
+struct Narrow<Circle<phys_t>, Capsule<phys_t> > {
+    static phys_t measure(Circle<phys_t>* a, Pose qa, Capsule<phys_t>* b,
+            Pose qb, vector2p& n, vector2p& w) {
+        phys_t d = Narrow<Capsule<phys_t>, Circle<phys_t> >::measure(b, qb, a,
+                qa, n, w);
+        w += n * d;
+        n = -n;
+        return d;
+    }
+};
+
+/**
+ * Terrain against any shape, through the shape's core in the terrain's
+ * frame. Each core vertex is dropped onto the surface below it, and the
+ * terrain samples under the core are measured against the core, so peaks
+ * between samples of the core are not missed.
+ */
+template<class B>
+struct Narrow<Terrain<phys_t>, B> {
+    static phys_t measure(Terrain<phys_t>* a, Pose qa, B* b, Pose qb,
+            vector2p& n, vector2p& w) {
+        Core c;
+        getCore(b, qb, c);
+        for (int i = 0; i < c.n; ++i)
+            c.v[i] = (c.v[i] - qa.p).unrotated(qa.r);
+        int s = a->getNumSamples();
+        phys_t best = std::numeric_limits<phys_t>::infinity();
+        // Span of the core in samples, relative to its first vertex.
+        phys_t t0 = 0.0, lo = 0.0, hi = 0.0;
+        for (int i = 0; i < c.n; ++i) {
+            phys_t l = c.v[i].length();
+            vector2p u = l > 0 ? c.v[i] / l : vector2p()(1.0, 0.0);
+            phys_t r = a->getRadius(u);
+            vector2p m = a->getNormal(u);
+            phys_t d = (l - r) * (m * u) - c.r;
+            if (d < best) {
+                best = d;
+                n = m;
+                w = u * r;
+            }
+            phys_t t = a->getIndex(u), pad = s;
+            if (l > c.r)
+                pad = c.r / (l - c.r) * s / (2 * PI);
+            if (i == 0)
+                t0 = t;
+            t -= t0;
+            t -= t > s / 2 ? s : t < -s / 2 ? -s : 0;
+            lo = min<phys_t> (lo, t - pad);
+            hi = max<phys_t> (hi, t + pad);
+        }
+        int first = (int) floor(t0 + lo), last = (int) ceil(t0 + hi);
+        if (last - first >= s)
+            last = first + s - 1;
+        for (int k = first; k <= last; ++k) {
+            vector2p p = a->getPoint((k % s + s) % s);
+            vector2p m;
+            phys_t d = measurePoint(c, p, m);
+            if (d < best) {
+                best = d;
+                n = m;
+                w = p;
+            }
+        }
+        n = n.rotated(qa.r);
+        w = qa.p + w.rotated(qa.r);
+        return best;
+    }
+    /** Measure from a point to a core, setting m to the normal to it. */
+    static phys_t measurePoint(const Core& c, vector2p p, vector2p& m) {
+        phys_t inside = -std::numeric_limits<phys_t>::infinity();
+        if (c.n > 2) {
+            // The core winds counterclockwise, so -~e points out of edge e.
+            for (int j = 0; j < c.n; ++j) {
+                vector2p o = -~(c.v[(j + 1) % c.n] - c.v[j]).unit();
+                phys_t d = (p - c.v[j]) * o;
+                if (d > inside) {
+                    inside = d;
+                    m = -o;
+                }
+            }
+            if (inside <= 0)
+                return inside - c.r;
+        }
+        phys_t dd = std::numeric_limits<phys_t>::infinity();
+        for (int j = 0; j < (c.n > 2 ? c.n : 1); ++j) {
+            vector2p q = closestOnSegment(c.v[j], c.v[(j + 1) % c.n], p);
+            if ((q - p).squared() < dd) {
+                dd = (q - p).squared();
+                m = q - p;
+            }
+        }
+        phys_t l = sqrt<phys_t> (dd);
+        m = l > 0 ? m / l : p.unit();
+        return l - c.r;
+    }
+};
+
+template<class A>
+struct Narrow<A, Terrain<phys_t> > {
+    static phys_t measure(A* a, Pose qa, Terrain<phys_t>* b, Pose qb,
+            vector2p& n, vector2p& w) {
+        phys_t d = Narrow<Terrain<phys_t>, A>::measure(b, qb, a, qa, n, w);
+        w += n * d;
+        n = -n;
+        return d;
+    }
+};
+
+/** Planets never meet, so terrains only measure their bounding circles. */
+template<>
+struct Narrow<Terrain<phys_t>, Terrain<phys_t> > {
+    static phys_t measure(Terrain<phys_t>* a, Pose qa, Terrain<phys_t>* b,
+            Pose qb, vector2p& n, vector2p& w) {
+        vector2p d = qb.p - qa.p;
+        phys_t l = d.length();
+        n = l > 0 ? d / l : vector2p()(1.0, 0.0);
+        w = qa.p + n * a->getBoundingRadius();
+        return l - a->getBoundingRadius() - b->getBoundingRadius();
+    }
+};
+
+/** Interpolate a body state to time t of a sweep from s to e. */
+static bodystate lerpBodyState(const bodystate& s, const bodystate& e,
+        phys_t t) {
+    bodystate r = s;
+    r.l = s.l * (1 - t) + e.l * t;
+    r.r = (s.r * (1 - t) + e.r * t).unit();
+    return r;
+}
+
+/**
+ * Sweep two shapes moving from sa and sb to na and nb, and find the first
+ * contact by conservative advancement: step forward by the distance
+ * between the shapes over the most their points can approach per unit
+ * time. On contact, na and nb are set to the states at time t, and p is
+ * set relative to a's position.
+ */
+template<class A, class B>
+struct Sweep {
+    static bool run(A* a, B* b, const bodystate& sa, const bodystate& sb,
+            bodystate& na, bodystate& nb, phys_t& t, vector2p& p,
+            vector2p& n) {
+        // Rotation by angle x moves the rotor by a chord of at least
+        // 2x / pi, which bounds the arc travelled by points on the shapes.
+        phys_t reach = ((nb.l.p - sb.l.p) - (na.l.p - sa.l.p)).length() +
+                (na.r - sa.r).length() * (PI / 2) * a->getBoundingRadius() +
+                (nb.r - sb.r).length() * (PI / 2) * b->getBoundingRadius();
+        phys_t slop = 1e-3 * (a->getBoundingRadius() +
+                b->getBoundingRadius());
+        vector2p w;
+        t = 0.0;
+        for (int i = 0; i < _MAX_ITERATIONS; ++i) {
+            bodystate ta = lerpBodyState(sa, na, t),
+                    tb = lerpBodyState(sb, nb, t);
+            Pose qa = { ta.l.p, ta.r }, qb = { tb.l.p, tb.r };
+            phys_t d = Narrow<A, B>::measure(a, qa, b, qb, n, w);
+            if (d <= slop) {
+                na = ta;
+                nb = tb;
+                p = w - ta.l.p;
+                return true;
+            }
+            if (reach <= 0)
+                return false;
+            t += d / reach;
+            if (t >= 1.0)
+                return false;
+        }
+        return false;
+    }
+    static const int _MAX_ITERATIONS = 32;
+};
+
+/** Circles sweep in closed form. */
+template<>
+struct Sweep<Circle<phys_t>, Circle<phys_t> > {
+    static bool run(Circle<phys_t>* a, Circle<phys_t>* b,
+            const bodystate& sa, const bodystate& sb, bodystate& na,
+            bodystate& nb, phys_t& t, vector2p& p, vector2p& n) {
+        phys_t ra = a->getRadius(), r = ra + b->getRadius(), rr = r * r;
+        vector2p d1 = sb.l.p - sa.l.p, d2 = nb.l.p - na.l.p;
+        phys_t t2, rt;
+        if (!intersectLineCircle(d1, d2, rr, t, t2) || t >= 1.0 || t2 < 0.0)
+            return false;
+        t = max<phys_t> (0.0, t);
+        rt = 1 - t;
+        na.l = sa.l * rt + na.l * t;
+        vector2p pa = na.l.p;
+        nb.l = sb.l * rt + nb.l * t;
+        n = (nb.l.p - pa) / r;
+        p = n * ra;
+        return true;
+    }
+};
+
+template<ShapeType T>
+struct ShapeClass;
+
+template<>
+struct ShapeClass<CIRCLE> {
+    typedef Circle<phys_t> type;
+};
+
+template<>
+struct ShapeClass<RECTANGLE> {
+    typedef Rectangle<phys_t> type;
+};
+
+template<>
+struct ShapeClass<CAPSULE> {
+    typedef Capsule<phys_t> type;
+};
+
+template<>
+struct ShapeClass<TERRAIN> {
+    typedef Terrain<phys_t> type;
+};
+
+template<ShapeType TA, ShapeType TB>
+static bool collidePair(Shape<phys_t>* a, Shape<phys_t>* b,
+        const bodystate& sa, const bodystate& sb, bodystate& na,
+        bodystate& nb, phys_t& t, vector2p& p, vector2p& n) {
+    typedef typename ShapeClass<TA>::type A;
+    typedef typename ShapeClass<TB>::type B;
+    return Sweep<A, B>::run((A*) a, (B*) b, sa, sb, na, nb, t, p, n);
+}
+
+typedef bool (*Collider)(Shape<phys_t>* a, Shape<phys_t>* b,
+        const bodystate& sa, const bodystate& sb, bodystate& na,
+        bodystate& nb, phys_t& t, vector2p& p, vector2p& n);
+
+#define COLLIDER_ROW(TA) { collidePair<TA, CIRCLE>, \
+        collidePair<TA, RECTANGLE>, collidePair<TA, CAPSULE>, \
+        collidePair<TA, TERRAIN> }
+
+/** Narrow phase for each pair of shape types, indexed by ShapeType. */
+static const Collider COLLIDERS[NUM_SHAPETYPE][NUM_SHAPETYPE] = {
+    COLLIDER_ROW(CIRCLE),
+    COLLIDER_ROW(RECTANGLE),
+    COLLIDER_ROW(CAPSULE),
+    COLLIDER_ROW(TERRAIN)
+};
+
+#undef COLLIDER_ROW
+
+bool collide(Body* a, Body* b, bodystate sa, bodystate sb, bodystate& na,
+        bodystate& nb, phys_t& t, vector2p& p, vector2p& n) {
+    Shape<phys_t> *ha = a->getShape(), *hb = b->getShape();
+    return COLLIDERS[ha->getType()][hb->getType()](ha, hb, sa, sb, na, nb, t,
+            p, n);
 }
 
 vector2p bounce1(Body* a, Body* b, vector2p& pa, vector2p pb, vector2p n,
@@ -107,3 +505,130 @@ vector2p bounce2(Body* a, Body* b, vector2p& pa, vector2p& pb, vector2p n,
     }
     return i;
 }
+
+void intersectRayCircles(vector2p o, vector2p d, const phys_t* cx,
+        const phys_t* cy, const phys_t* rr, int n, phys_t* t) {
+    const phys_t inf = std::numeric_limits<phys_t>::infinity();
+    int i = 0;
+#if defined(__SSE2__) && PHYS_FLOAT
+    const __m128 ox = _mm_set1_ps(o.x), oy = _mm_set1_ps(o.y),
+            dx = _mm_set1_ps(d.x), dy = _mm_set1_ps(d.y),
+            zero = _mm_setzero_ps(), miss = _mm_set1_ps(inf);
+    for (; i + 4 <= n; i += 4) {
+        __m128 mx = _mm_sub_ps(ox, _mm_loadu_ps(cx + i));
+        __m128 my = _mm_sub_ps(oy, _mm_loadu_ps(cy + i));
+        __m128 b = _mm_add_ps(_mm_mul_ps(mx, dx), _mm_mul_ps(my, dy));
+        __m128 c = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(mx, mx),
+                _mm_mul_ps(my, my)), _mm_loadu_ps(rr + i));
+        __m128 disc = _mm_sub_ps(_mm_mul_ps(b, b), c);
+        __m128 h = _mm_sub_ps(_mm_sub_ps(zero, b),
+                _mm_sqrt_ps(_mm_max_ps(disc, zero)));
+        __m128 hit = _mm_and_ps(_mm_cmpge_ps(disc, zero),
+                _mm_cmpge_ps(h, zero));
+        _mm_storeu_ps(t + i, _mm_or_ps(_mm_and_ps(hit, h),
+                _mm_andnot_ps(hit, miss)));
+    }
+#elif defined(__SSE2__)
+    const __m128d ox = _mm_set1_pd(o.x), oy = _mm_set1_pd(o.y),
+            dx = _mm_set1_pd(d.x), dy = _mm_set1_pd(d.y),
+            zero = _mm_setzero_pd(), miss = _mm_set1_pd(inf);
+    for (; i + 2 <= n; i += 2) {
+        __m128d mx = _mm_sub_pd(ox, _mm_loadu_pd(cx + i));
+        __m128d my = _mm_sub_pd(oy, _mm_loadu_pd(cy + i));
+        __m128d b = _mm_add_pd(_mm_mul_pd(mx, dx), _mm_mul_pd(my, dy));
+        __m128d c = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(mx, mx),
+                _mm_mul_pd(my, my)), _mm_loadu_pd(rr + i));
+        __m128d disc = _mm_sub_pd(_mm_mul_pd(b, b), c);
+        __m128d h = _mm_sub_pd(_mm_sub_pd(zero, b),
+                _mm_sqrt_pd(_mm_max_pd(disc, zero)));
+        __m128d hit = _mm_and_pd(_mm_cmpge_pd(disc, zero),
+                _mm_cmpge_pd(h, zero));
+        _mm_storeu_pd(t + i, _mm_or_pd(_mm_and_pd(hit, h),
+                _mm_andnot_pd(hit, miss)));
+    }
+#endif
+    for (; i < n; ++i) {
+        phys_t mx = o.x - cx[i], my = o.y - cy[i];
+        phys_t b = mx * d.x + my * d.y, disc = b * b - (mx * mx + my * my -
+                rr[i]);
+        phys_t h = disc >= 0 ? -b - sqrt<phys_t> (disc) : -1;
+        t[i] = h >= 0 ? h : inf;
+    }
+}
+
+/**
+ * Evaluate the Stumpff functions c2(z) and c3(z) used by KeplerOrbit.
+ */
+static void stumpff(phys_t z, phys_t& c, phys_t& s) {
+    if (z > 1e-6) {
+        phys_t sz = sqrt<phys_t> (z);
+        c = (1 - cos<phys_t> (sz)) / z;
+        s = (sz - sin<phys_t> (sz)) / (sz * z);
+    } else if (z < -1e-6) {
+        phys_t sz = sqrt<phys_t> (-z);
+        c = (cosh(sz) - 1) / -z;
+        s = (sinh(sz) - sz) / (sz * -z);
+    } else {
+        c = 1.0 / 2.0 - z * (1.0 / 24.0 - z / 720.0);
+        s = 1.0 / 6.0 - z * (1.0 / 120.0 - z / 5040.0);
+    }
+}
+
+KeplerOrbit::KeplerOrbit() :
+        epoch_(state2p()(0.0, 0.0, 0.0, 0.0)),
+        gm_(0.0),
+        sqrtGm_(0.0),
+        r0_(0.0),
+        vr0_(0.0),
+        alpha_(0.0),
+        time_(0.0),
+        chi_(0.0),
+        r_(0.0) {
+}
+
+void KeplerOrbit::setEpoch(state2p s, phys_t gm) {
+    epoch_ = s;
+    gm_ = gm;
+    sqrtGm_ = sqrt<phys_t> (gm);
+    r0_ = r_ = s.p.length();
+    vr0_ = s.p * s.v / r0_;
+    alpha_ = 2 / r0_ - s.v.squared() / gm;
+    time_ = chi_ = 0.0;
+}
+
+state2p KeplerOrbit::advance(phys_t dt) {
+    time_ += dt;
+    // Solve the universal Kepler equation with Newton's method. The anomaly
+    // grows at sqrt(gm) / r, so last step's value is an excellent guess.
+    phys_t chi = chi_ + sqrtGm_ * dt / r_, z, c, s;
+    phys_t k = r0_ * vr0_ / sqrtGm_, l = 1 - alpha_ * r0_;
+    phys_t tolerance = 4 * std::numeric_limits<phys_t>::epsilon();
+    for (int i = 0; i < 8; ++i) {
+        phys_t chi2 = chi * chi;
+        z = alpha_ * chi2;
+        stumpff(z, c, s);
+        phys_t f = k * chi2 * c + l * chi2 * chi * s + r0_ * chi -
+                sqrtGm_ * time_;
+        phys_t df = k * chi * (1 - z * s) + l * chi2 * c + r0_;
+        phys_t delta = f / df;
+        chi -= delta;
+        if (abs<phys_t> (delta) <= tolerance * (1 + abs<phys_t> (chi)))
+            break;
+    }
+    phys_t chi2 = chi * chi;
+    z = alpha_ * chi2;
+    stumpff(z, c, s);
+    phys_t f = 1 - chi2 / r0_ * c, g = time_ - chi2 * chi * s / sqrtGm_;
+    state2p r;
+    r.p = epoch_.p * f + epoch_.v * g;
+    r_ = r.p.length();
+    phys_t df = sqrtGm_ / (r_ * r0_) * (alpha_ * chi2 * chi * s - chi);
+    phys_t dg = 1 - chi2 / r_ * c;
+    r.v = epoch_.p * df + epoch_.v * dg;
+    chi_ = chi;
+    // Start over from the current state after each revolution to keep the
+    // anomaly small.
+    if (z > 4 * PI * PI)
+        setEpoch(r, gm_);
+    return r;
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Physics microbenchmarks. Each hot expression is timed as written with the
+ * vector2/state2 operators and as a hand-fused loop over the components. If
+ * the operators compile to straight-line code, the two take the same time.
+ * The ExactMath and FastMath policies are timed side by side, and the
+ * largest error of each FastMath function over its documented range is
+ * reported.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "physics.hxx"
+
+/** Number of states in the working set. */
+static const int N = 1024;
+/** Number of passes over the working set. */
+static const int PASSES = 20000;
+
+static state2p s[N], ds[4][N], r[N];
+static phys_t dt = 1.0 / 600.0, f = 0.25;
+/** Arguments for the maths functions, and circles for the ray queries. */
+static phys_t x[N], y[N], dsq[N];
+/** Results, not static so that the compiler cannot drop the loops. */
+phys_t z[N];
+
+static void rk4Operators() {
+    for (int i = 0; i < N; ++i)
+        r[i] = s[i] + (ds[0][i] + (ds[1][i] + ds[2][i]) * 2.0 + ds[3][i]) *
+                (dt / 6.0);
+}
+
+static void rk4Fused() {
+    phys_t h = dt / 6.0;
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            for (int k = 0; k < 2; ++k)
+                r[i][j][k] = s[i][j][k] + (ds[0][i][j][k] + (ds[1][i][j][k] +
+                        ds[2][i][j][k]) * 2 + ds[3][i][j][k]) * h;
+        }
+    }
+}
+
+static void lerpOperators() {
+    for (int i = 0; i < N; ++i)
+        r[i] = s[i] * (1 - f) + ds[0][i] * f;
+}
+
+static void lerpFused() {
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            for (int k = 0; k < 2; ++k)
+                r[i][j][k] = s[i][j][k] * (1 - f) + ds[0][i][j][k] * f;
+        }
+    }
+}
+
+static void momentumOperators() {
+    for (int i = 0; i < N; ++i) {
+        vector2p p = s[i].p, m = (s[i].v + ~p * f - ds[0][i].v) * dt;
+        r[i].p = m - ~p * (~p * m * dt / (f + dt * p.squared()));
+    }
+}
+
+static void momentumFused() {
+    for (int i = 0; i < N; ++i) {
+        phys_t px = s[i].p.x, py = s[i].p.y;
+        phys_t mx = (s[i].v.x - py * f - ds[0][i].v.x) * dt;
+        phys_t my = (s[i].v.y + px * f - ds[0][i].v.y) * dt;
+        phys_t q = (-py * mx + px * my) * dt / (f + dt * (px * px + py * py));
+        r[i].p.x = mx + py * q;
+        r[i].p.y = my - px * q;
+    }
+}
+
+template<class M>
+static void sinCos() {
+    for (int i = 0; i < N; ++i)
+        z[i] = M::template sin<phys_t> (x[i]) + M::template cos<phys_t> (y[i]);
+}
+
+template<class M>
+static void atan2() {
+    for (int i = 0; i < N; ++i)
+        z[i] = M::template atan2<phys_t> (y[i], x[i]);
+}
+
+template<class M>
+static void pow() {
+    for (int i = 0; i < N; ++i)
+        z[i] = M::template pow<phys_t> (0.75, x[i]);
+}
+
+template<class M>
+static void rsqrt() {
+    for (int i = 0; i < N; ++i)
+        z[i] = M::template rsqrt<phys_t> (y[i] + 2);
+}
+
+static void rayCirclesKernel() {
+    vector2p o = { 0, 0 }, d = { 0.6, 0.8 };
+    intersectRayCircles(o, d, x, y, dsq, N, z);
+}
+
+static void rayCirclesScalar() {
+    vector2p o = { 0, 0 }, d = { 0.6, 0.8 };
+    phys_t t1, t2;
+    for (int i = 0; i < N; ++i) {
+        vector2p a = o - vector2p()(x[i], y[i]);
+        z[i] = intersectLineCircle(a, a + d, dsq[i], t1, t2) && t1 >= 0 ?
+                t1 : HUGE_VAL;
+    }
+}
+
+struct Benchmark {
+    const char* name;
+    void (*run)();
+};
+
+static const Benchmark BENCHMARKS[] = {
+    { "rk4 combine, operators", rk4Operators },
+    { "rk4 combine, fused", rk4Fused },
+    { "state lerp, operators", lerpOperators },
+    { "state lerp, fused", lerpFused },
+    { "momentum at point, operators", momentumOperators },
+    { "momentum at point, fused", momentumFused },
+    { "sin + cos, exact", sinCos<ExactMath> },
+    { "sin + cos, fast", sinCos<FastMath> },
+    { "atan2, exact", atan2<ExactMath> },
+    { "atan2, fast", atan2<FastMath> },
+    { "pow, exact", pow<ExactMath> },
+    { "pow, fast", pow<FastMath> },
+    { "rsqrt, exact", rsqrt<ExactMath> },
+    { "rsqrt, fast", rsqrt<FastMath> },
+    { "ray vs circle, scalar", rayCirclesScalar },
+    { "ray vs circle, kernel", rayCirclesKernel },
+    { NULL, NULL }
+};
+
+/** Largest absolute or relative error of FastMath, sampled over a range. */
+static void reportErrors() {
+    const int SAMPLES = 1000000;
+    double eSin = 0, eCos = 0, eAtan2 = 0, eExp2 = 0, eLog2 = 0, ePow = 0,
+            eRsqrt = 0;
+    for (int i = 0; i < SAMPLES; ++i) {
+        double u = (i + 0.5) / SAMPLES, v = u * 2 - 1, a = v * 1e4;
+        eSin = max(eSin, fabs(FastMath::sin(a) - sin(a)));
+        eCos = max(eCos, fabs(FastMath::cos(a) - cos(a)));
+        double ay = sin(u * 2 * PI), ax = cos(u * 2 * PI);
+        eAtan2 = max(eAtan2, fabs(FastMath::atan2(ay, ax) - atan2(ay, ax)));
+        double e = v * 1000;
+        eExp2 = max(eExp2, fabs(FastMath::exp2(e) / exp2(e) - 1));
+        double l = exp2(v * 1000), q = exp2(v * 120);
+        eLog2 = max(eLog2, fabs(FastMath::log2(l) - log2(l)));
+        double b = 0.01 + u * 4, p = v * 100;
+        ePow = max(ePow, fabs(FastMath::pow(b, p) / pow(b, p) - 1) /
+                (1 + fabs(p * log2(b))));
+        eRsqrt = max(eRsqrt, fabs(FastMath::rsqrt(q) * sqrt(q) - 1));
+    }
+    printf("\n%-32s %10s\n", "FastMath<double>", "max error");
+    printf("%-32s %10.3g\n", "sin, |x| < 1e4, absolute", eSin);
+    printf("%-32s %10.3g\n", "cos, |x| < 1e4, absolute", eCos);
+    printf("%-32s %10.3g\n", "atan2, absolute", eAtan2);
+    printf("%-32s %10.3g\n", "exp2, |x| < 1000, relative", eExp2);
+    printf("%-32s %10.3g\n", "log2, absolute", eLog2);
+    printf("%-32s %10.3g\n", "pow, relative / (1 + |y log2 x|)", ePow);
+    printf("%-32s %10.3g\n", "rsqrt, |log2 x| < 120, relative", eRsqrt);
+}
+
+int main() {
+    srand(1);
+    for (int i = 0; i < N; ++i) {
+        x[i] = rand() * 20.0 / RAND_MAX - 10;
+        y[i] = rand() * 2.0 / RAND_MAX - 1;
+        dsq[i] = rand() * 4.0 / RAND_MAX;
+        for (int j = 0; j < 4; ++j) {
+            s[i][j / 2][j % 2] = rand() * 2.0 / RAND_MAX - 1;
+            for (int k = 0; k < 4; ++k)
+                ds[k][i][j / 2][j % 2] = rand() * 2.0 / RAND_MAX - 1;
+        }
+    }
+    printf("%-32s %10s\n", "benchmark", "ns/eval");
+    for (const Benchmark* b = BENCHMARKS; b->name; ++b) {
+        b->run();
+        clock_t start = clock();
+        for (int i = 0; i < PASSES; ++i)
+            b->run();
+        double ns = (clock() - start) * 1e9 / CLOCKS_PER_SEC / PASSES / N;
+        printf("%-32s %10.3f\n", b->name, ns);
+    }
+    reportErrors();
+    return 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Physics precision harness. Replays a scripted match without graphics and
+ * prints a trace of the characters' states. Given the trace of another
+ * build with -c, it reports how far this build drifts from it instead:
+ *
+ *     ./physics-drift > double.trace
+ *     ./physics-drift-float -c double.trace
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "game.hxx"
+
+/** Steps per second, as in GameLoop. */
+static const double STEPS_PER_SECOND = 150;
+/** Steps between each trace line. */
+static const int TRACE_INTERVAL = 150;
+/** Steps between each scripted input. */
+static const int INPUT_INTERVAL = 15;
+
+/** Deterministic pseudo-random numbers, independent of the C library. */
+static unsigned int nextRandom(unsigned int& seed) {
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 16;
+}
+
+/** Feed a scripted input to a character. */
+static void script(Character* c, unsigned int r) {
+    bool press = r & 1;
+    switch ((r >> 1) % 6) {
+    case 0:
+        c->moveLeft(press ? 1.0 : 0.0);
+        break;
+    case 1:
+        c->moveRight(press ? 1.0 : 0.0);
+        break;
+    case 2:
+        c->jump(press);
+        break;
+    case 3:
+        c->crouch(press);
+        break;
+    case 4:
+        c->leftPunch(press);
+        break;
+    default:
+        c->rightPunch(press);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int steps = 60 * STEPS_PER_SECOND, numCharacters = 4, opt;
+    const char* reference = NULL;
+    while ((opt = getopt(argc, argv, "s:n:c:")) != -1) {
+        switch (opt) {
+        case 's':
+            steps = atoi(optarg);
+            break;
+        case 'n':
+            numCharacters = max(atoi(optarg), 1);
+            break;
+        case 'c':
+            reference = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-s steps] [-n characters] "
+                    "[-c reference]\n", argv[0]);
+            return 1;
+        }
+    }
+    FILE* ref = NULL;
+    if (reference && !(ref = fopen(reference, "r"))) {
+        fprintf(stderr, "ERROR: Could not open %s.\n", reference);
+        return 1;
+    }
+    Game game(NULL, numCharacters, 0);
+    numCharacters = game.getNumPlayers();
+    printf("# %d-bit physics, %d characters, %d steps\n",
+            (int) sizeof(phys_t) * 8, numCharacters, steps);
+    unsigned int seed = 1;
+    double maxDrift = 0.0, sumDrift = 0.0, maxMassDrift = 0.0;
+    int lines = 0;
+    for (int step = 1; step <= steps; ++step) {
+        if (step % INPUT_INTERVAL == 0) {
+            for (int i = 0; i < numCharacters; ++i)
+                script(game.getCharacter(i), nextRandom(seed));
+        }
+        game.step(1.0 / STEPS_PER_SECOND);
+        if (step % TRACE_INTERVAL)
+            continue;
+        if (!ref) {
+            printf("%d", step);
+            for (int i = 0; i < numCharacters; ++i) {
+                Character* c = game.getCharacter(i);
+                vector2p p = c->getState().p;
+                printf(" %.9g %.9g %.9g", (double) p.x, (double) p.y,
+                        (double) c->getMass());
+            }
+            printf("\n");
+            continue;
+        }
+        // Skip comments and compare against the reference line.
+        int refStep = -1;
+        char c;
+        while (fscanf(ref, " %c", &c) == 1 && c == '#')
+            while (fgetc(ref) != '\n' && !feof(ref)) ;
+        ungetc(c, ref);
+        if (fscanf(ref, "%d", &refStep) != 1 || refStep != step) {
+            fprintf(stderr, "ERROR: Reference does not match at step %d.\n",
+                    step);
+            return 1;
+        }
+        double drift = 0.0, massDrift = 0.0;
+        for (int i = 0; i < numCharacters; ++i) {
+            double x, y, m;
+            if (fscanf(ref, "%lf %lf %lf", &x, &y, &m) != 3) {
+                fprintf(stderr, "ERROR: Reference is truncated.\n");
+                return 1;
+            }
+            Character* c = game.getCharacter(i);
+            vector2p p = c->getState().p;
+            drift = max(drift, hypot(p.x - x, p.y - y));
+            massDrift = max(massDrift, fabs(c->getMass() - m));
+        }
+        printf("%d %.3g %.3g\n", step, drift, massDrift);
+        maxDrift = max(maxDrift, drift);
+        maxMassDrift = max(maxMassDrift, massDrift);
+        sumDrift += drift;
+        ++lines;
+    }
+    if (ref) {
+        printf("# max position drift %.3g, mean %.3g, max mass drift %.3g\n",
+                maxDrift, lines ? sumDrift / lines : 0.0, maxMassDrift);
+        fclose(ref);
+    }
+    return 0;
+}
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unistd.h>
+#include "planner.hxx"
+
+/** Ways of moving, and other actions, tried alone and in every pairing. */
+static const ActionType MOVES[] = { NOTHING, LEFT, RIGHT };
+static const ActionType ACTIONS[] = { NOTHING, JUMP, CROUCH, LPUNCH,
+        RPUNCH };
+static const int NUM_MOVES = sizeof(MOVES) / sizeof(MOVES[0]),
+        NUM_CANDIDATES = NUM_MOVES * sizeof(ACTIONS) / sizeof(ACTIONS[0]);
+/** Weight of the distance to the nearest opponent against mass. */
+static const phys_t CLOSING = 2.0;
+
+/** Get input k of those tried. */
+static StepInput getCandidate(int k) {
+    StepInput input = { 0, 0, 0 };
+    input.set(MOVES[k % NUM_MOVES], 1.0);
+    input.set(ACTIONS[k / NUM_MOVES], 1.0);
+    return input;
+}
+
+Planner::Planner(int numCharacters, int first) :
+        numCharacters_(numCharacters),
+        first_(first),
+        mutex_(SDL_CreateMutex()),
+        recorded_(SDL_CreateCond()),
+        stopping_(false),
+        steps_(),
+        inputs_(),
+        base_(0),
+        plans_(numCharacters - first),
+        workers_() {
+    // Leave a processor to the game itself.
+    int n = min(max((int) sysconf(_SC_NPROCESSORS_ONLN) - 1, 1),
+            numCharacters - first);
+    steps_.reserve(_TRIM * 2);
+    inputs_.reserve(_TRIM * 2 * numCharacters);
+    for (int i = 0; i < n; ++i) {
+        Worker* w = new Worker();
+        w->planner = this;
+        w->thread = NULL;
+        w->game = new Game(NULL, numCharacters, 0);
+        for (int c = first + i; c < numCharacters; c += n)
+            w->characters.push_back(c);
+        w->done = 0;
+        w->sincePlan = 0;
+        w->round = 0;
+        w->held.resize(numCharacters);
+        workers_.push_back(w);
+    }
+    // Building a game must not overlap a worker stepping another, so every
+    // copy is built before the first worker starts.
+    for (std::vector<Worker*>::iterator i = workers_.begin();
+            i != workers_.end(); ++i)
+        (*i)->thread = SDL_CreateThread(run, *i);
+}
+
+Planner::~Planner() {
+    SDL_mutexP(mutex_);
+    stopping_ = true;
+    SDL_CondBroadcast(recorded_);
+    SDL_mutexV(mutex_);
+    for (std::vector<Worker*>::iterator i = workers_.begin();
+            i != workers_.end(); ++i) {
+        SDL_WaitThread((*i)->thread, NULL);
+        delete (*i)->game;
+        delete (*i);
+    }
+    SDL_DestroyCond(recorded_);
+    SDL_DestroyMutex(mutex_);
+}
+
+void Planner::record(const StepInput* inputs, phys_t dt) {
+    SDL_mutexP(mutex_);
+    steps_.push_back(dt);
+    inputs_.insert(inputs_.end(), inputs, inputs + numCharacters_);
+    SDL_CondBroadcast(recorded_);
+    SDL_mutexV(mutex_);
+}
+
+StepInput Planner::getPlan(int i) {
+    SDL_mutexP(mutex_);
+    StepInput plan = plans_[i - first_];
+    SDL_mutexV(mutex_);
+    return plan;
+}
+
+int Planner::getNumThreads() {
+    return workers_.size();
+}
+
+int Planner::run(void* worker) {
+    Worker* w = (Worker*) worker;
+    while (w->planner->replay(w)) {
+        if (w->sincePlan >= _REPLAN)
+            w->planner->plan(w);
+    }
+    return 0;
+}
+
+bool Planner::replay(Worker* w) {
+    SDL_mutexP(mutex_);
+    while (!stopping_ && w->done == base_ + (int) steps_.size())
+        SDL_CondWait(recorded_, mutex_);
+    if (stopping_) {
+        SDL_mutexV(mutex_);
+        return false;
+    }
+    int first = w->done - base_, n = steps_.size() - first;
+    w->steps.assign(steps_.begin() + first, steps_.end());
+    w->inputs.assign(inputs_.begin() + first * numCharacters_,
+            inputs_.end());
+    w->done += n;
+    // Forget the steps every worker has replayed.
+    int done = w->done;
+    for (std::vector<Worker*>::iterator i = workers_.begin();
+            i != workers_.end(); ++i)
+        done = min(done, (*i)->done);
+    if (done - base_ >= _TRIM) {
+        steps_.erase(steps_.begin(), steps_.begin() + (done - base_));
+        inputs_.erase(inputs_.begin(), inputs_.begin() +
+                (done - base_) * numCharacters_);
+        base_ = done;
+    }
+    SDL_mutexV(mutex_);
+    // Take the steps just as the game did.
+    for (int s = 0; s < n; ++s) {
+        const StepInput* input = &w->inputs[s * numCharacters_];
+        for (int c = 0; c < numCharacters_; ++c) {
+            input[c].apply(w->game->getPlayer(c), w->held[c]);
+            w->held[c] = input[c];
+        }
+        w->game->step(w->steps[s]);
+    }
+    w->sincePlan += n;
+    return true;
+}
+
+void Planner::plan(Worker* w) {
+    Game* game = w->game;
+    phys_t dt = w->steps.back();
+    game->save(w->snapshot);
+    Uint32 start = SDL_GetTicks();
+    int m = w->characters.size();
+    for (int k = 0; k < m; ++k) {
+        int c = w->characters[k];
+        // Each character gets its share of the budget, and whatever the
+        // ones before it left.
+        Uint32 deadline = start + _BUDGET * (k + 1) / m;
+        phys_t best = 0;
+        // Score carrying on as now first, then try the others, starting
+        // from a different one each plan.
+        for (int j = -1; j < NUM_CANDIDATES; ++j) {
+            StepInput input = j < 0 ? w->held[c] :
+                    getCandidate((j + w->round) % NUM_CANDIDATES);
+            if (j >= 0 && input == w->held[c])
+                continue;
+            game->restore(w->snapshot, false);
+            input.apply(game->getPlayer(c), w->held[c]);
+            int s = 0;
+            for (; s < _HORIZON && (s % 10 || SDL_GetTicks() < deadline);
+                    ++s)
+                game->step(dt);
+            // Out of time: the best so far stands.
+            if (s < _HORIZON)
+                break;
+            phys_t score = evaluate(game, c);
+            if (j >= 0 && score <= best)
+                continue;
+            best = score;
+            if (j < 0)
+                continue;
+            SDL_mutexP(mutex_);
+            plans_[c - first_] = input;
+            SDL_mutexV(mutex_);
+        }
+    }
+    // Carry on from where the game is.
+    game->restore(w->snapshot, false);
+    w->sincePlan = 0;
+    ++w->round;
+}
+
+phys_t Planner::evaluate(Game* game, int i) {
+    Character* self = game->getCharacter(i);
+    if (self->isDead())
+        return -HUGE_VAL;
+    // Keep mass, take it from the others, and close in on the nearest.
+    vector2p p = self->getState().p;
+    phys_t score = self->getMass(), nearest = HUGE_VAL;
+    for (int j = 0; j < numCharacters_; ++j) {
+        Character* other = game->getCharacter(j);
+        if (j == i || other->isDead())
+            continue;
+        score -= other->getMass() / (numCharacters_ - 1);
+        nearest = min(nearest, (other->getState().p - p).length());
+    }
+    return nearest < HUGE_VAL ? score - nearest * CLOSING : score;
+}
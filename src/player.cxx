@@ -17,87 +17,22 @@
  * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <SDL/SDL.h>
 #include "character.hxx"
 #include "player.hxx"
 
 Player::Player(Character* character) :
-    Actor(character) {
-    // Initialise bindings_ to avoid gibberish
-    for (int i = 0; i < SDLK_LAST; ++i)
-        keyBindings_[i] = NOTHING;
-    for (int i = 0; i < 256; ++i)  {
-        joyAxisBindings_[i] = NOTHING;
-        joyButtonBindings_[i] = NOTHING;
-    }
+    Actor(character),
+    capture_(NULL) {
 }
 
-bool Player::handle(const SDL_Event& event) {
-    double value;
-    int input;
-    ActionType* bindings;
-    switch (event.type) {
-    case SDL_KEYUP:
-    case SDL_KEYDOWN:
-        value = event.key.state == SDL_PRESSED ? 1.0 : 0.0;
-        input = event.key.keysym.sym;
-        bindings = keyBindings_;
-        break;
-    case SDL_JOYBUTTONUP:
-    case SDL_JOYBUTTONDOWN:
-        value = event.jbutton.state == SDL_PRESSED ? 1.0 : 0.0;
-        input = event.jbutton.button;
-        bindings = joyButtonBindings_;
-        break;
-    case SDL_JOYAXISMOTION:
-        value = event.jaxis.value / 32768.0;
-        input = event.jaxis.which;
-        bindings = joyAxisBindings_;
-        break;
-    default:
-        return false;
-    }
-    switch (bindings[input]) {
-    case LEFT:
-            character_->moveLeft(value);
-        break;
-    case RIGHT:
-            character_->moveRight(value);
-        break;
-    case JUMP:
-        character_->jump(value);
-        break;
-    case CROUCH:
-        character_->crouch(value);
-        break;
-    case FIRE:
-        character_->fire(value);
-        break;
-    case LPUNCH:
-        character_->leftPunch(value);
-        break;
-    case RPUNCH:
-        character_->rightPunch(value);
-        break;
-    case LKICK:
-        character_->leftKick(value);
-        break;
-    case RKICK:
-        character_->rightKick(value);
-        break;
-    case SUICIDE:
-        character_->die();
-        break;
-    default:
-        return false;
+bool Player::input(ActionType action, double value) {
+    if (capture_) {
+        capture_->set(action, value);
+        return true;
     }
-    return true;
-}
-
-void Player::bindKey(SDLKey key, ActionType action) {
-    keyBindings_[key] = action;
+    return act(action, value);
 }
 
-void Player::bindJoyButton(Uint8 joyButton, ActionType action) {
-    joyButtonBindings_[joyButton] = action;
+void Player::setCapture(StepInput* input) {
+    capture_ = input;
 }
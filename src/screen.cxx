@@ -111,7 +111,8 @@ void Screen::initGl() {
 }
 
 Screen::Screen() :
-        drawingMode_(0) {
+        drawingMode_(0),
+        batch_() {
 }
 
 void Screen::setDrawingMode(int mode, int mask, bool update) {
@@ -141,6 +142,10 @@ void Screen::updateDrawingMode() {
         glDisable(GL_POLYGON_SMOOTH);
 }
 
+DrawBatch* Screen::getBatch() {
+    return &batch_;
+}
+
 bool Screen::handle(const SDL_Event& event) {
     if (event.type == SDL_VIDEORESIZE) {
         _surfaceWidth_ = event.resize.w;
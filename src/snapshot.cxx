@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "physics.hxx"
+#include "snapshot.hxx"
+
+Snapshot::Snapshot() :
+        data_(),
+        size_(0),
+        pos_(0),
+        good_(false) {
+}
+
+void Snapshot::clear() {
+    size_ = 0;
+    Header h = { _VERSION, sizeof(phys_t), sizeof(Header) };
+    write(h);
+}
+
+bool Snapshot::rewind() {
+    pos_ = 0;
+    good_ = true;
+    Header h = { 0, 0, 0 };
+    read(h);
+    good_ = good_ && h.version == _VERSION && h.physSize == sizeof(phys_t) &&
+            h.size == size_;
+    return good_;
+}
+
+bool Snapshot::isGood() {
+    return good_;
+}
+
+const char* Snapshot::getData() {
+    return size_ ? &data_[0] : NULL;
+}
+
+int Snapshot::getSize() {
+    return size_;
+}
+
+void Snapshot::setData(const char* data, int size) {
+    reserve(size);
+    if (size)
+        memcpy(&data_[0], data, size);
+    size_ = size;
+    pos_ = 0;
+}
+
+void Snapshot::reserve(int size) {
+    if ((int) data_.size() < size)
+        data_.resize(size);
+}
+
+char* Snapshot::grow(int n) {
+    if (size_ + n > (int) data_.size())
+        data_.resize(max<int> (data_.size() * 2, size_ + n));
+    char* p = &data_[0] + size_;
+    size_ += n;
+    // Keep the header's size current, so that a cut snapshot is refused.
+    if (size_ >= (int) sizeof(Header))
+        memcpy(&data_[0] + offsetof(Header, size), &size_, sizeof(size_));
+    return p;
+}
+
+const char* Snapshot::take(int n) {
+    if (!good_ || n < 0 || pos_ + n > size_) {
+        good_ = false;
+        return NULL;
+    }
+    const char* p = &data_[0] + pos_;
+    pos_ += n;
+    return p;
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "state_frame.hxx"
+
+const phys_t StateFrame::_POSITION_UNIT = 1.0 / 1024;
+const phys_t StateFrame::_MASS_UNIT = 1.0 / 64;
+
+/** Difference between two angles, the short way around. */
+static int angleDelta(int a, int b) {
+    return ((b - a + 0x8000) & 0xffff) - 0x8000;
+}
+
+static void putVarint(std::vector<unsigned char>& out, unsigned int v) {
+    while (v >= 0x80) {
+        out.push_back((v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+    out.push_back(v);
+}
+
+static bool getVarint(const unsigned char*& p, const unsigned char* end,
+        unsigned int& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 35; shift += 7) {
+        v |= (unsigned int) (*p & 0x7f) << shift;
+        if (!(*p++ & 0x80))
+            return true;
+    }
+    return false;
+}
+
+/** Map signed to unsigned so that small magnitudes stay small. */
+static unsigned int zigzag(int v) {
+    return (unsigned int) v << 1 ^ (unsigned int) (v >> 31);
+}
+
+static int unzigzag(unsigned int v) {
+    return (int) (v >> 1) ^ -(int) (v & 1);
+}
+
+StateFrame::StateFrame() :
+        tick_(0),
+        values_(_HEADER_SIZE, 0) {
+}
+
+void StateFrame::resize(int numCharacters) {
+    values_.resize(_HEADER_SIZE + numCharacters * _CHARACTER_SIZE, 0);
+}
+
+int StateFrame::getNumCharacters() const {
+    return (values_.size() - _HEADER_SIZE) / _CHARACTER_SIZE;
+}
+
+int StateFrame::getTick() const {
+    return tick_;
+}
+
+void StateFrame::setTick(int tick) {
+    tick_ = tick;
+}
+
+int StateFrame::getPlanetAngle() const {
+    return values_[0];
+}
+
+void StateFrame::setPlanetAngle(int angle) {
+    values_[0] = angle;
+}
+
+int* StateFrame::getCharacter(int i) {
+    return &values_[_HEADER_SIZE + i * _CHARACTER_SIZE];
+}
+
+const int* StateFrame::getCharacter(int i) const {
+    return &values_[_HEADER_SIZE + i * _CHARACTER_SIZE];
+}
+
+void StateFrame::interpolate(const StateFrame& a, const StateFrame& b,
+        phys_t t) {
+    *this = b;
+    if (a.values_.size() != b.values_.size())
+        return;
+    tick_ = a.tick_ + (int) floor((b.tick_ - a.tick_) * t + 0.5);
+    for (int i = 0; i < (int) values_.size(); ++i) {
+        int j = (i - _HEADER_SIZE) % _CHARACTER_SIZE;
+        if (i >= _HEADER_SIZE && j == FLAGS)
+            continue;
+        int d = isAngle(i) ? angleDelta(a.values_[i], b.values_[i]) :
+                b.values_[i] - a.values_[i];
+        values_[i] = a.values_[i] + (int) floor(d * t + 0.5);
+        if (isAngle(i))
+            values_[i] &= 0xffff;
+    }
+}
+
+void StateFrame::encode(const StateFrame* base,
+        std::vector<unsigned char>& out) const {
+    int n = values_.size();
+    putVarint(out, getNumCharacters());
+    // Each group of eight values starts with a byte of which changed.
+    for (int i = 0; i < n; i += 8) {
+        int mask = 0, m = min(8, n - i), deltas[8];
+        for (int k = 0; k < m; ++k) {
+            int v = values_[i + k], b = base ? base->values_[i + k] : 0;
+            deltas[k] = isAngle(i + k) ? angleDelta(b, v) : v - b;
+            mask |= (deltas[k] != 0) << k;
+        }
+        out.push_back(mask);
+        for (int k = 0; k < m; ++k) {
+            if (mask >> k & 1)
+                putVarint(out, zigzag(deltas[k]));
+        }
+    }
+}
+
+int StateFrame::decode(const StateFrame* base, const unsigned char* data,
+        int size) {
+    const unsigned char* p = data, * end = data + size;
+    unsigned int v;
+    if (!getVarint(p, end, v) || v > 255 ||
+            (base && (int) v != base->getNumCharacters()))
+        return -1;
+    resize(v);
+    int n = values_.size();
+    for (int i = 0; i < n; i += 8) {
+        if (p == end)
+            return -1;
+        int mask = *p++, m = min(8, n - i);
+        for (int k = 0; k < m; ++k) {
+            int b = base ? base->values_[i + k] : 0, d = 0;
+            if (mask >> k & 1) {
+                if (!getVarint(p, end, v))
+                    return -1;
+                d = unzigzag(v);
+            }
+            values_[i + k] = isAngle(i + k) ? (b + d) & 0xffff : b + d;
+        }
+    }
+    return p - data;
+}
+
+int StateFrame::toPosition(phys_t x) {
+    // Clamped, for debris drifting off into space.
+    return (int) floor(clampmag<phys_t> (x / _POSITION_UNIT, 1 << 30) + 0.5);
+}
+
+phys_t StateFrame::fromPosition(int x) {
+    return x * _POSITION_UNIT;
+}
+
+int StateFrame::toAngle(vector2p rotor) {
+    return (int) floor(rotor.angle() * (0x8000 / PI) + 0.5) & 0xffff;
+}
+
+vector2p StateFrame::fromAngle(int angle) {
+    return vector2p::fromAngle(angle * (PI / 0x8000));
+}
+
+int StateFrame::toMass(phys_t m) {
+    return (int) floor(m / _MASS_UNIT + 0.5);
+}
+
+phys_t StateFrame::fromMass(int m) {
+    return m * _MASS_UNIT;
+}
+
+int StateFrame::toFade(float f) {
+    return (int) floor(f * _OPAQUE + 0.5f);
+}
+
+float StateFrame::fromFade(int f) {
+    return (float) f / _OPAQUE;
+}
+
+bool StateFrame::isAngle(int i) {
+    if (i < _HEADER_SIZE)
+        return true;
+    int j = (i - _HEADER_SIZE) % _CHARACTER_SIZE;
+    return j >= PARTS && (j - PARTS) % PART_SIZE == PART_ANGLE;
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "character.hxx"
+#include "state_stream.hxx"
+
+static const unsigned char MAGIC[] = { 'L', 'O', 'S', 'T' };
+/** Number of a planet's body, and of a body that is not known. */
+static const unsigned int PLANET = 0x80000000u, UNKNOWN = 0xffffffffu;
+
+StateStream::StateStream() :
+        socket_(-1),
+        path_(),
+        readers_(),
+        collisions_(),
+        packet_(),
+        frame_(0),
+        step_(0),
+        dropped_(0) {
+}
+
+StateStream::~StateStream() {
+    for (std::vector<int>::iterator i = readers_.begin();
+            i != readers_.end(); ++i)
+        close(*i);
+    if (socket_ < 0)
+        return;
+    close(socket_);
+    unlink(path_.c_str());
+}
+
+bool StateStream::open(const char* path) {
+    sockaddr_un a;
+    memset(&a, 0, sizeof(a));
+    a.sun_family = AF_UNIX;
+    if (socket_ >= 0 || strlen(path) >= sizeof(a.sun_path))
+        return false;
+    strcpy(a.sun_path, path);
+    socket_ = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if (socket_ < 0)
+        return false;
+    unlink(path);
+    if (bind(socket_, (sockaddr*) &a, sizeof(a)) < 0 ||
+            listen(socket_, _MAX_READERS) < 0 ||
+            fcntl(socket_, F_SETFL, fcntl(socket_, F_GETFL) | O_NONBLOCK) <
+            0) {
+        close(socket_);
+        socket_ = -1;
+        return false;
+    }
+    path_ = path;
+    return true;
+}
+
+void StateStream::collect(Game* game) {
+    ++step_;
+    if (readers_.empty())
+        return;
+    const std::vector<CollisionEvent>& events =
+            game->getUniverse()->getCollisions();
+    for (std::vector<CollisionEvent>::const_iterator i = events.begin();
+            i != events.end() && (int) collisions_.size() < _MAX_COLLISIONS;
+            ++i) {
+        Collision c = { { getBodyNumber(game, i->body[0]),
+                getBodyNumber(game, i->body[1]) }, (float) i->position.x,
+                (float) i->position.y, (float) i->impulse };
+        collisions_.push_back(c);
+    }
+}
+
+void StateStream::publish(Game* game) {
+    if (socket_ < 0)
+        return;
+    int r;
+    while ((int) readers_.size() < _MAX_READERS &&
+            (r = accept(socket_, NULL, NULL)) >= 0)
+        readers_.push_back(r);
+    ++frame_;
+    if (readers_.empty())
+        return;
+    int numPlanets = game->getNumPlanets(),
+            numCharacters = game->getNumPlayers();
+    packet_.clear();
+    packet_.insert(packet_.end(), MAGIC, MAGIC + sizeof(MAGIC));
+    putU32(_VERSION);
+    putU32(frame_);
+    putU32(step_);
+    putU32(numPlanets);
+    putU32(numCharacters);
+    putU32(collisions_.size());
+    // Filled in at the end.
+    putU32(0);
+    for (int i = 0; i < numPlanets; ++i) {
+        AstroBody* p = game->getPlanet(i);
+        putF32(p->getPosition().x);
+        putF32(p->getPosition().y);
+        putF32(p->getRotor().angle());
+        putF32(p->getShape()->getBoundingRadius());
+    }
+    for (int i = 0; i < numCharacters; ++i) {
+        Character* c = game->getCharacter(i);
+        putU32(c->isDead() | (c->getOrientation() == 'l') << 1);
+        putF32(c->getMass());
+        SmallBody* bodies[6];
+        c->getBodies(bodies);
+        for (int j = 0; j < 6; ++j) {
+            putF32(bodies[j]->getPosition().x);
+            putF32(bodies[j]->getPosition().y);
+            putF32(bodies[j]->getRotor().angle());
+        }
+    }
+    for (std::vector<Collision>::const_iterator i = collisions_.begin();
+            i != collisions_.end(); ++i) {
+        putU32(i->body[0]);
+        putU32(i->body[1]);
+        putF32(i->x);
+        putF32(i->y);
+        putF32(i->impulse);
+    }
+    collisions_.clear();
+    unsigned int size = packet_.size();
+    for (int i = 0; i < 4; ++i)
+        packet_[28 + i] = size >> (i * 8) & 0xff;
+    for (int i = readers_.size() - 1; i >= 0; --i) {
+        if (send(readers_[i], &packet_[0], size,
+                MSG_DONTWAIT | MSG_NOSIGNAL) >= 0)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            ++dropped_;
+            continue;
+        }
+        // The reader has gone.
+        close(readers_[i]);
+        readers_.erase(readers_.begin() + i);
+    }
+}
+
+int StateStream::getNumReaders() {
+    return readers_.size();
+}
+
+int StateStream::getDropped() {
+    return dropped_;
+}
+
+unsigned int StateStream::getBodyNumber(Game* game, Body* body) {
+    for (int i = 0; i < game->getNumPlanets(); ++i) {
+        if (game->getPlanet(i) == body)
+            return PLANET + i;
+    }
+    SmallBody* bodies[6];
+    for (int i = 0; i < game->getNumPlayers(); ++i) {
+        game->getCharacter(i)->getBodies(bodies);
+        for (int j = 0; j < 6; ++j) {
+            if (bodies[j] == body)
+                return i * 6 + j;
+        }
+    }
+    return UNKNOWN;
+}
+
+void StateStream::putU32(unsigned int v) {
+    for (int i = 0; i < 4; ++i)
+        packet_.push_back(v >> (i * 8) & 0xff);
+}
+
+void StateStream::putF32(float v) {
+    unsigned int u;
+    memcpy(&u, &v, sizeof(u));
+    putU32(u);
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include "actor.hxx"
+#include "step_input.hxx"
+
+void StepInput::set(ActionType a, double value) {
+    if (a == NOTHING)
+        return;
+    unsigned short bit = 1 << a;
+    bool move = a == LEFT || a == RIGHT;
+    held = value > 0 || (move && value) ? held | bit : held & ~bit;
+    signed char speed = move ? floor(clampmag(value, 1.0) * 127 + 0.5) : 0;
+    if (a == LEFT)
+        left = speed;
+    else if (a == RIGHT)
+        right = speed;
+}
+
+void StepInput::apply(Actor* actor, const StepInput& previous) const {
+    for (int a = NOTHING + 1; a < NUM_ACTIONTYPE; ++a) {
+        bool was = previous.held >> a & 1, is = held >> a & 1;
+        if (a == LEFT && is && left != previous.left)
+            was = false;
+        if (a == RIGHT && is && right != previous.right)
+            was = false;
+        // Suicide cannot be taken back, so only the press counts.
+        if (was == is || (a == SUICIDE && !is))
+            continue;
+        double value = is ? 1.0 : 0.0;
+        if (a == LEFT)
+            value = left / 127.0;
+        else if (a == RIGHT)
+            value = right / 127.0;
+        actor->act((ActionType) a, value);
+    }
+}
+
+bool StepInput::operator==(const StepInput& i) const {
+    return held == i.held && left == i.left && right == i.right;
+}
+
+bool StepInput::operator!=(const StepInput& i) const {
+    return !(*this == i);
+}
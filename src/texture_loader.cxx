@@ -23,18 +23,16 @@
 
 const GLint FORMAT[] = { GL_LUMINANCE, GL_LUMINANCE_ALPHA, GL_RGB, GL_RGBA };
 
-TextureLoader* TextureLoader::_instance_ = 0;
-
-TextureLoader* TextureLoader::getInstance() {
-    if (!_instance_ && Screen::getInstance())
-        _instance_ = new TextureLoader();
-    return _instance_;
-}
-
 TextureLoader::TextureLoader() :
         loaded_() {
 }
 
+TextureLoader::~TextureLoader() {
+    for (std::map<std::string, GLuint>::iterator i = loaded_.begin();
+            i != loaded_.end(); ++i)
+        glDeleteTextures(1, &i->second);
+}
+
 GLuint TextureLoader::getTexture(const char* filename) {
     std::map<std::string, GLuint>::iterator it = loaded_.find(filename);
     if (it != loaded_.end())
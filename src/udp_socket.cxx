@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "udp_socket.hxx"
+
+UdpSocket::UdpSocket() :
+        socket_(-1) {
+}
+
+UdpSocket::~UdpSocket() {
+    if (socket_ >= 0)
+        close(socket_);
+}
+
+bool UdpSocket::open(unsigned short port) {
+    if (socket_ >= 0)
+        close(socket_);
+    socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (socket_ < 0)
+        return false;
+    sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_ANY);
+    a.sin_port = htons(port);
+    if (bind(socket_, (sockaddr*) &a, sizeof(a)) < 0 ||
+            fcntl(socket_, F_SETFL, fcntl(socket_, F_GETFL) | O_NONBLOCK) <
+            0) {
+        close(socket_);
+        socket_ = -1;
+        return false;
+    }
+    return true;
+}
+
+bool UdpSocket::isOpen() {
+    return socket_ >= 0;
+}
+
+unsigned short UdpSocket::getPort() {
+    sockaddr_in a;
+    socklen_t n = sizeof(a);
+    if (getsockname(socket_, (sockaddr*) &a, &n) < 0)
+        return 0;
+    return ntohs(a.sin_port);
+}
+
+int UdpSocket::receive(unsigned char* data, int size, sockaddr_in* from) {
+    sockaddr_in a;
+    socklen_t n = sizeof(a);
+    int r = recvfrom(socket_, data, size, 0, (sockaddr*) &a, &n);
+    if (r < 0)
+        return -1;
+    if (from)
+        *from = a;
+    return r;
+}
+
+void UdpSocket::send(const unsigned char* data, int size,
+        const sockaddr_in& to) {
+    sendto(socket_, data, size, 0, (const sockaddr*) &to, sizeof(to));
+}
+
+bool UdpSocket::resolve(const char* address, sockaddr_in& a) {
+    std::string host = address;
+    std::string::size_type colon = host.rfind(':');
+    if (colon == std::string::npos)
+        return false;
+    std::string port = host.substr(colon + 1);
+    host = host.substr(0, colon);
+    addrinfo hints, * info;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &info))
+        return false;
+    memcpy(&a, info->ai_addr, sizeof(a));
+    freeaddrinfo(info);
+    return true;
+}
+
+sockaddr_in UdpSocket::getLocalAddress(unsigned short port) {
+    sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    a.sin_port = htons(port);
+    return a;
+}
+
+bool UdpSocket::isSameAddress(const sockaddr_in& a, const sockaddr_in& b) {
+    return a.sin_addr.s_addr == b.sin_addr.s_addr &&
+            a.sin_port == b.sin_port;
+}
+
+void UdpSocket::putU32(unsigned char* p, unsigned int v) {
+    for (int i = 0; i < 4; ++i)
+        p[i] = v >> (i * 8) & 0xff;
+}
+
+unsigned int UdpSocket::getU32(const unsigned char* p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (unsigned int) p[3] << 24;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Checks the narrow phase of the capsule and box shapes: whether a sweep
+ * hits, its time of impact, and the contact normal and point.
+ */
+
+#include <stdio.h>
+#include "physics.hxx"
+
+/** Tolerance on times, normals and points, above the sweeps' slop. */
+static const phys_t TOLERANCE = 1e-2;
+
+/** A body that only lends its shape to collide. */
+class ShapeBody: public Body {
+public:
+    ShapeBody(Shape<phys_t>* shape) :
+            Body(state2p()(0.0, 0.0, 0.0, 0.0), 1.0, 0.0, 0.0, 1.0, shape,
+                    NULL) { }
+};
+
+static bodystate pose(phys_t x, phys_t y, phys_t angle) {
+    bodystate s;
+    s.l = state2p()(x, y, 0.0, 0.0);
+    s.r = vector2p::fromAngle(angle);
+    s.av = 0.0;
+    return s;
+}
+
+static int failures = 0;
+
+static bool near(vector2p a, vector2p b) {
+    return (a - b).length() <= TOLERANCE;
+}
+
+/**
+ * Sweep b from sb to eb past a resting at sa, and check that it hits at
+ * time t with normal n from a to b and contact point p relative to a.
+ */
+static void expectHit(const char* name, Shape<phys_t>* a, Shape<phys_t>* b,
+        bodystate sa, bodystate sb, bodystate eb, phys_t t, vector2p n,
+        vector2p p) {
+    ShapeBody ba(a), bb(b);
+    bodystate na = sa, nb = eb;
+    phys_t tc;
+    vector2p pc, nc;
+    if (!collide(&ba, &bb, sa, sb, na, nb, tc, pc, nc)) {
+        fprintf(stderr, "FAIL: %s: no hit\n", name);
+        ++failures;
+        return;
+    }
+    if (abs<phys_t> (tc - t) > TOLERANCE || !near(nc, n) || !near(pc, p)) {
+        fprintf(stderr, "FAIL: %s: hit at %g, normal (%g, %g), point "
+                "(%g, %g); expected %g, (%g, %g), (%g, %g)\n", name,
+                (double) tc, (double) nc.x, (double) nc.y, (double) pc.x,
+                (double) pc.y, (double) t, (double) n.x, (double) n.y,
+                (double) p.x, (double) p.y);
+        ++failures;
+    }
+}
+
+/** Sweep b from sb to eb past a resting at sa, and check that it misses. */
+static void expectMiss(const char* name, Shape<phys_t>* a, Shape<phys_t>* b,
+        bodystate sa, bodystate sb, bodystate eb) {
+    ShapeBody ba(a), bb(b);
+    bodystate na = sa, nb = eb;
+    phys_t tc;
+    vector2p pc, nc;
+    if (collide(&ba, &bb, sa, sb, na, nb, tc, pc, nc)) {
+        fprintf(stderr, "FAIL: %s: hit at %g\n", name, (double) tc);
+        ++failures;
+    }
+}
+
+int main() {
+    Capsule<phys_t> capsule(2.0, 0.5);
+    Rectangle<phys_t> box(2.0, 2.0);
+    Circle<phys_t> circle(0.5);
+    const bodystate origin = pose(0.0, 0.0, 0.0);
+    const vector2p up = { 0.0, 1.0 }, right = { 1.0, 0.0 };
+    // Capsule against circle.
+    expectHit("circle onto capsule side", &capsule, &circle, origin,
+            pose(0.5, 3.0, 0.0), pose(0.5, -3.0, 0.0), 1.0 / 3, up,
+            vector2p()(0.5, 0.5));
+    expectHit("circle onto capsule end", &capsule, &circle, origin,
+            pose(4.0, 0.0, 0.0), pose(-4.0, 0.0, 0.0), 0.25, right,
+            vector2p()(1.5, 0.0));
+    expectHit("circle onto turned capsule", &capsule, &circle,
+            pose(0.0, 0.0, PI / 2), pose(0.0, 4.0, 0.0),
+            pose(0.0, -4.0, 0.0), 0.25, up, vector2p()(0.0, 1.5));
+    expectMiss("circle past capsule end", &capsule, &circle, origin,
+            pose(2.1, 3.0, 0.0), pose(2.1, -3.0, 0.0));
+    expectHit("capsule onto circle", &circle, &capsule, origin,
+            pose(0.5, 3.0, 0.0), pose(0.5, -3.0, 0.0), 1.0 / 3,
+            vector2p()(0.0, 1.0), vector2p()(0.0, 0.5));
+    // Box against box, circle and capsule. A slight turn leaves one corner
+    // of the moving box foremost, so the contact point is unique.
+    const phys_t c = cos(0.1), s = sin(0.1);
+    expectHit("box onto box face", &box, &box, origin, pose(5.0, 0.0, 0.1),
+            pose(-5.0, 0.0, 0.1), (4.0 - c - s) / 10, right,
+            vector2p()(1.0, c - s));
+    expectHit("box corner onto box face", &box, &box, origin,
+            pose(5.0, 0.0, PI / 4), pose(-5.0, 0.0, PI / 4),
+            (4.0 - sqrt<phys_t> (2.0)) / 10, right, vector2p()(1.0, 0.0));
+    expectMiss("box past box", &box, &box, origin, pose(5.0, 2.1, 0.0),
+            pose(-5.0, 2.1, 0.0));
+    expectHit("circle onto box", &box, &circle, origin, pose(0.0, 5.0, 0.0),
+            pose(0.0, -5.0, 0.0), 0.35, up, vector2p()(0.0, 1.0));
+    expectMiss("circle past box corner", &box, &circle, origin,
+            pose(-5.0, 8.5, 0.0), pose(5.0, -1.5, 0.0));
+    expectHit("capsule end onto box", &box, &capsule, origin,
+            pose(0.0, 5.0, PI / 2), pose(0.0, -5.0, PI / 2), 0.25, up,
+            vector2p()(0.0, 1.0));
+    expectMiss("capsule past box", &box, &capsule, origin,
+            pose(3.6, 5.0, 0.0), pose(3.6, -5.0, 0.0));
+    return failures ? 1 : 0;
+}
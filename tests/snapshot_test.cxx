@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This file is part of Limbs Off.
+ *
+ * Limbs Off is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Limbs Off is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Limbs Off.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Checks that restoring a snapshot gives back a world that plays on as if
+ * it had never left it, also when a character died in between, and that
+ * a snapshot cut short is refused.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "game.hxx"
+#include "player.hxx"
+#include "snapshot.hxx"
+
+/** Steps per second, as in GameLoop. */
+static const double STEPS_PER_SECOND = 150;
+/** Steps for the characters to land before the snapshot is taken. */
+static const int WARM_UP_STEPS = 600;
+/** Steps played from the snapshot. */
+static const int STEPS = 300;
+
+/** Play on from the snapshot with the first player walking right. */
+static void play(Game& game, Snapshot& from, Snapshot& to) {
+    game.restore(from, true);
+    game.getPlayer(0)->input(RIGHT, 1.0);
+    for (int i = 0; i < STEPS; ++i)
+        game.step(1.0 / STEPS_PER_SECOND);
+    game.getPlayer(0)->input(RIGHT, 0.0);
+    game.save(to);
+}
+
+static bool same(Snapshot& a, Snapshot& b) {
+    return a.getSize() == b.getSize() &&
+            memcmp(a.getData(), b.getData(), a.getSize()) == 0;
+}
+
+/** Whether a game restored after a death plays on as before it. */
+static bool testRestoreAfterDeath() {
+    Game game(NULL, 2, 0);
+    Snapshot start, expected, actual;
+    for (int i = 0; i < WARM_UP_STEPS; ++i)
+        game.step(1.0 / STEPS_PER_SECOND);
+    game.save(start);
+    play(game, start, expected);
+    game.restore(start, true);
+    game.getCharacter(0)->die();
+    game.step(1.0 / STEPS_PER_SECOND);
+    play(game, start, actual);
+    return same(expected, actual);
+}
+
+/** Whether a game restored to before a step it just took repeats it. */
+static bool testRestoreRepeats() {
+    Game game(NULL, 2, 0);
+    Snapshot start, expected, actual;
+    for (int i = 0; i < WARM_UP_STEPS; ++i)
+        game.step(1.0 / STEPS_PER_SECOND);
+    game.save(start);
+    play(game, start, expected);
+    play(game, start, actual);
+    return same(expected, actual);
+}
+
+/** Whether a snapshot cut short is refused, leaving the game be. */
+static bool testRestoreCutShort() {
+    Game game(NULL, 2, 0);
+    Snapshot start, cut, expected, actual;
+    for (int i = 0; i < WARM_UP_STEPS; ++i)
+        game.step(1.0 / STEPS_PER_SECOND);
+    game.save(start);
+    cut.setData(start.getData(), start.getSize() / 2);
+    for (int i = 0; i < STEPS; ++i)
+        game.step(1.0 / STEPS_PER_SECOND);
+    game.save(expected);
+    bool refused = !game.restore(cut, true);
+    game.save(actual);
+    return refused && same(expected, actual);
+}
+
+int main() {
+    int failures = 0;
+    if (!testRestoreRepeats()) {
+        fprintf(stderr, "FAIL: restoring does not repeat the steps\n");
+        ++failures;
+    }
+    if (!testRestoreAfterDeath()) {
+        fprintf(stderr, "FAIL: restoring after a death does not repeat "
+                "the steps\n");
+        ++failures;
+    }
+    if (!testRestoreCutShort()) {
+        fprintf(stderr, "FAIL: a snapshot cut short is not refused\n");
+        ++failures;
+    }
+    return failures ? 1 : 0;
+}